@@ -1,283 +0,0 @@
-#include "roundy_digit_layer.h"
-
-#include <stdlib.h>
-#include <string.h>
-#include <time.h>
-
-#include "roundy_glyphs.h"
-#include "roundy_layout.h"
-#include "roundy_palette.h"
-#include <math.h>
-
-/* Animation tuning */
-#define DIAG_FRAME_MS 16 /* target frame interval in ms (approx 60Hz -> 16ms) */
-#define DIAG_DURATION_MS 120 /* total animation duration in ms (short and snappy) */
-/* initial delay before starting the first animation frame (user requested value) */
-#define DIAG_START_DELAY_MS 180
-
-/* choose animation color based on progress: three steps
- * 0.0 - 0.333: #555555
- * 0.333 - 0.666: #AAAAAA
- * 0.666 - 1.0: #FFFFFF
- */
-static GColor prv_anim_color(float p) {
-  if (p < (1.0f / 3.0f)) {
-    return PBL_IF_COLOR_ELSE(GColorFromRGB(0x55, 0x55, 0x55), GColorBlack);
-  } else if (p < (2.0f / 3.0f)) {
-    return PBL_IF_COLOR_ELSE(GColorFromRGB(0xAA, 0xAA, 0xAA), GColorBlack);
-  } else {
-    return PBL_IF_COLOR_ELSE(GColorFromRGB(0xFF, 0xFF, 0xFF), GColorWhite);
-  }
-}
-
-typedef struct {
-  int16_t digits[CONNECTED_DIGIT_COUNT];
-  bool use_24h_time;
-  /* animation state */
-  AppTimer *anim_timer;
-  float diag_progress;
-} ConnectedDigitLayerState;
-
-struct ConnectedDigitLayer {
-  Layer *layer;
-  ConnectedDigitLayerState *state;
-};
-
-static inline ConnectedDigitLayerState *prv_get_state(ConnectedDigitLayer *layer) {
-  return layer ? layer->state : NULL;
-}
-
-/* Draw a single cell. The diagonal inside the cell is interpolated between
- * the original (\) and the opposite (/) based on layer->diag_progress.
- * progress == 0.0 -> original (x = origin_x + idx)
- * progress == 1.0 -> flipped (x = origin_x + (cell_size-1-idx))
- */
-static void prv_draw_digit_cell(GContext *ctx, int cell_col, int cell_row,
-                               float progress) {
-  const GRect frame = connected_cell_frame(cell_col, cell_row);
-  graphics_fill_rect(ctx, frame, 0, GCornerNone);
-
-  const int origin_x = frame.origin.x;
-  const int origin_y = frame.origin.y;
-  const float p = progress;
-  for (int idx = 0; idx < CONNECTED_CELL_SIZE; ++idx) {
-    const int from_x = idx;
-    const int to_x = (CONNECTED_CELL_SIZE - 1 - idx);
-    const int x = origin_x + (int)roundf((1.0f - p) * from_x + p * to_x);
-    const int y = origin_y + idx;
-    graphics_draw_pixel(ctx, GPoint(x, y));
-  }
-}
-
-static void prv_draw_glyph(GContext *ctx, const ConnectedGlyph *glyph, int cell_col,
-                           int cell_row, float progress) {
-  if (!glyph) {
-    return;
-  }
-
-  for (int row = 0; row < CONNECTED_DIGIT_HEIGHT; ++row) {
-    const uint8_t mask = glyph->rows[row];
-    if (!mask) {
-      continue;
-    }
-    for (int col = 0; col < glyph->width; ++col) {
-      if (mask & (1 << (glyph->width - 1 - col))) {
-        prv_draw_digit_cell(ctx, cell_col + col, cell_row + row, progress);
-      }
-    }
-  }
-}
-
-static void prv_draw_digit(GContext *ctx, int16_t digit, int cell_col, int cell_row, float progress) {
-  if (digit < CONNECTED_GLYPH_ZERO || digit > CONNECTED_GLYPH_NINE) {
-    return;
-  }
-
-  prv_draw_glyph(ctx, &CONNECTED_GLYPHS[digit], cell_col, cell_row, progress);
-}
-
-static void prv_draw_colon(GContext *ctx, int cell_col, int cell_row, float progress) {
-  prv_draw_glyph(ctx, &CONNECTED_GLYPHS[CONNECTED_GLYPH_COLON], cell_col, cell_row, progress);
-}
-
-static void prv_digit_layer_update_proc(Layer *layer, GContext *ctx) {
-  ConnectedDigitLayerState *state = layer_get_data(layer);
-  if (!state) {
-    return;
-  }
-
-  graphics_context_set_fill_color(ctx, connected_palette_digit_fill());
-  /* During animation select a step color for stroke (diagonals). After animation
-   * finishes, fall back to the normal palette stroke color. */
-  GColor stroke_color = connected_palette_digit_stroke();
-  if (state->diag_progress < 1.0f) {
-    stroke_color = prv_anim_color(state->diag_progress);
-  }
-  graphics_context_set_stroke_color(ctx, stroke_color);
-
-  int cell_col = CONNECTED_DIGIT_START_COL;
-  const int cell_row = CONNECTED_DIGIT_START_ROW;
-
-  prv_draw_digit(ctx, state->digits[0], cell_col, cell_row, state->diag_progress);
-  cell_col += CONNECTED_DIGIT_WIDTH + CONNECTED_DIGIT_GAP;
-
-  prv_draw_digit(ctx, state->digits[1], cell_col, cell_row, state->diag_progress);
-  /* pass animation progress into drawing to interpolate diagonals */
-  cell_col += CONNECTED_DIGIT_WIDTH + CONNECTED_DIGIT_GAP;
-
-  prv_draw_colon(ctx, cell_col, cell_row, state->diag_progress);
-  cell_col += CONNECTED_DIGIT_COLON_WIDTH + CONNECTED_DIGIT_GAP;
-
-  prv_draw_digit(ctx, state->digits[2], cell_col, cell_row, state->diag_progress);
-  cell_col += CONNECTED_DIGIT_WIDTH + CONNECTED_DIGIT_GAP;
-
-  prv_draw_digit(ctx, state->digits[3], cell_col, cell_row, state->diag_progress);
-}
-
-ConnectedDigitLayer *connected_digit_layer_create(GRect frame) {
-  ConnectedDigitLayer *layer = calloc(1, sizeof(*layer));
-  if (!layer) {
-    return NULL;
-  }
-
-  layer->layer = layer_create_with_data(frame, sizeof(ConnectedDigitLayerState));
-  if (!layer->layer) {
-    free(layer);
-    return NULL;
-  }
-
-  layer->state = layer_get_data(layer->layer);
-  layer->state->use_24h_time = clock_is_24h_style();
-  for (int i = 0; i < CONNECTED_DIGIT_COUNT; ++i) {
-    layer->state->digits[i] = -1;
-  }
-
-  layer_set_update_proc(layer->layer, prv_digit_layer_update_proc);
-  return layer;
-}
-
-
-void connected_digit_layer_destroy(ConnectedDigitLayer *layer) {
-  if (!layer) {
-    return;
-  }
-  if (layer->layer) {
-    /* cancel any running animation timer stored in layer data */
-    ConnectedDigitLayerState *state = layer_get_data(layer->layer);
-    if (state && state->anim_timer) {
-      app_timer_cancel(state->anim_timer);
-      state->anim_timer = NULL;
-    }
-    layer_destroy(layer->layer);
-  }
-  free(layer);
-}
-
-Layer *connected_digit_layer_get_layer(ConnectedDigitLayer *layer) {
-  return layer ? layer->layer : NULL;
-}
-
-/* Animation timer callback: ctx is the Layer* whose data is ConnectedDigitLayerState */
-static void prv_diag_anim_timer(void *ctx) {
-  Layer *layer = (Layer *)ctx;
-  if (!layer) {
-    return;
-  }
-  ConnectedDigitLayerState *state = layer_get_data(layer);
-  if (!state) {
-    return;
-  }
-  const int FRAME_MS = DIAG_FRAME_MS;
-  const int DURATION_MS = DIAG_DURATION_MS;
-  const float delta = (float)FRAME_MS / (float)DURATION_MS;
-
-  state->diag_progress += delta;
-  if (state->diag_progress >= 1.0f) {
-    state->diag_progress = 1.0f;
-    /* animation finished */
-    state->anim_timer = NULL;
-  } else {
-    /* re-register next frame */
-    state->anim_timer = app_timer_register(FRAME_MS, prv_diag_anim_timer, layer);
-  }
-
-  layer_mark_dirty(layer);
-}
-
-void connected_digit_layer_start_diag_flip(ConnectedDigitLayer *rdl) {
-  if (!rdl || !rdl->layer) {
-    return;
-  }
-  ConnectedDigitLayerState *state = layer_get_data(rdl->layer);
-  if (!state) {
-    return;
-  }
-  /* Cancel existing timer if any */
-  if (state->anim_timer) {
-    app_timer_cancel(state->anim_timer);
-    state->anim_timer = NULL;
-  }
-  state->diag_progress = 0.0f;
-  /* start after a very short delay (FRAME_MS) to create the requested small delay
-   * and drive a fast animation */
-  /* schedule first frame after a slightly larger startup delay */
-  state->anim_timer = app_timer_register(DIAG_START_DELAY_MS, prv_diag_anim_timer, rdl->layer);
-}
-
-void connected_digit_layer_set_time(ConnectedDigitLayer *layer, const struct tm *time_info) {
-  ConnectedDigitLayerState *state = prv_get_state(layer);
-  if (!state || !time_info) {
-    return;
-  }
-
-  const bool use_24h = clock_is_24h_style();
-  int hour = time_info->tm_hour;
-  if (!use_24h) {
-    hour %= 12;
-    if (hour == 0) {
-      hour = 12;
-    }
-  }
-
-  int16_t new_digits[CONNECTED_DIGIT_COUNT] = {
-    hour / 10,
-    hour % 10,
-    time_info->tm_min / 10,
-    time_info->tm_min % 10,
-  };
-
-  if (!use_24h && hour < 10) {
-    new_digits[0] = -1;
-  }
-
-  bool changed = (state->use_24h_time != use_24h);
-  for (int i = 0; i < CONNECTED_DIGIT_COUNT; ++i) {
-    if (state->digits[i] != new_digits[i]) {
-      state->digits[i] = new_digits[i];
-      changed = true;
-    }
-  }
-
-  if (state->use_24h_time != use_24h) {
-    state->use_24h_time = use_24h;
-  }
-
-  if (changed && layer->layer) {
-    layer_mark_dirty(layer->layer);
-  }
-}
-
-void connected_digit_layer_refresh_time(ConnectedDigitLayer *layer) {
-  time_t now = time(NULL);
-  struct tm *time_info = localtime(&now);
-  if (!time_info) {
-    return;
-  }
-  connected_digit_layer_set_time(layer, time_info);
-}
-
-void connected_digit_layer_force_redraw(ConnectedDigitLayer *layer) {
-  if (layer && layer->layer) {
-    layer_mark_dirty(layer->layer);
-  }
-}
@@ -0,0 +1,11 @@
+#pragma once
+
+/* Connected: a short, snappy flip of all glyphs at once.
+ *
+ * The engine lives in roundy/src/c, see roundy/src/face/roundy_face_config.h
+ * for what each constant controls. */
+
+#define ROUNDY_FACE_GLYPH_DURATION_MS 120
+#define ROUNDY_FACE_GLYPH_STAGGER_MS 0
+#define ROUNDY_FACE_INTRO_DELAY_MS 180
+#define ROUNDY_FACE_MINUTE_DELAY_MS 16
@@ -0,0 +1,1117 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "roundy_host.h"
+
+/* Host implementation of the pebble.h stand-in. It aims to be exact where
+ * the engine's output depends on it (pixels, clipping, layer order, timer
+ * order) and simple everywhere else. */
+
+#define HOST_MAX_PERSIST_KEYS 32
+
+struct GBitmap {
+  uint8_t *data;
+  uint16_t stride;
+  GBitmapFormat format;
+  GRect bounds;
+  /* size of the pixel data, the bounds may cover less of it */
+  GSize data_size;
+  bool owns_data;
+};
+
+struct Layer {
+  GRect frame;
+  GRect bounds;
+  Layer *parent;
+  Layer *first_child;
+  Layer *next_sibling;
+  LayerUpdateProc update_proc;
+  bool hidden;
+  const char *name;
+  void *data;
+};
+
+struct GContext {
+  GBitmap *dest;
+  /* where the drawing layer's bounds origin is in the framebuffer */
+  GPoint offset;
+  /* in framebuffer coordinates */
+  GRect clip;
+  GColor fill;
+  GColor stroke;
+  GCompOp comp_op;
+  bool captured;
+  RoundyHostStats *section;
+};
+
+/* Handles are ids that are never reused, so cancelling a timer that already
+ * fired is harmless, as on the watch. */
+typedef struct HostTimer {
+  uintptr_t id;
+  uint64_t deadline_ms;
+  AppTimerCallback callback;
+  void *data;
+  struct HostTimer *next;
+} HostTimer;
+
+typedef struct {
+  bool used;
+  uint32_t key;
+  size_t size;
+  uint8_t data[PERSIST_DATA_MAX_LENGTH];
+} HostPersistEntry;
+
+typedef struct {
+  uint64_t now_ms;
+  bool is_24h;
+  bool bitmap_alloc_fails;
+  AppLogLevel log_level;
+
+  GBitmap framebuffer;
+  uint8_t framebuffer_data[PBL_DISPLAY_HEIGHT * PBL_DISPLAY_WIDTH];
+  /* visible span of every framebuffer row */
+  int16_t row_min_x[PBL_DISPLAY_HEIGHT];
+  int16_t row_max_x[PBL_DISPLAY_HEIGHT];
+  uint32_t visible_pixels;
+
+  Layer *root;
+  GColor background;
+  bool dirty;
+  uint32_t frame_index;
+  RoundyHostFrameHandler frame_handler;
+  void *frame_handler_context;
+
+  HostTimer *timers;
+  uintptr_t next_timer_id;
+
+  HostPersistEntry persist[HOST_MAX_PERSIST_KEYS];
+
+  RoundyHostStats stats[ROUNDY_HOST_MAX_SECTIONS];
+  uint32_t stats_frame[ROUNDY_HOST_MAX_SECTIONS];
+  int section_count;
+} RoundyHost;
+
+static RoundyHost s_host;
+
+static uint64_t prv_monotonic_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return ((uint64_t)now.tv_sec * 1000000000u) + (uint64_t)now.tv_nsec;
+}
+
+static inline uint64_t prv_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc();
+#else
+  return prv_monotonic_ns();
+#endif
+}
+
+/* What the frames cost as a whole, see roundy_host_get_stats(). */
+static inline RoundyHostStats *prv_frame_stats(void) {
+  return &s_host.stats[0];
+}
+
+/* Geometry and colours */
+
+bool gpoint_equal(const GPoint *const point_a, const GPoint *const point_b) {
+  return point_a->x == point_b->x && point_a->y == point_b->y;
+}
+
+bool grect_equal(const GRect *const rect_a, const GRect *const rect_b) {
+  return gpoint_equal(&rect_a->origin, &rect_b->origin) && rect_a->size.w == rect_b->size.w &&
+         rect_a->size.h == rect_b->size.h;
+}
+
+bool gcolor_equal(GColor8 x, GColor8 y) {
+  return x.argb == y.argb;
+}
+
+static GRect prv_intersect(GRect a, GRect b) {
+  const int x0 = (a.origin.x > b.origin.x) ? a.origin.x : b.origin.x;
+  const int y0 = (a.origin.y > b.origin.y) ? a.origin.y : b.origin.y;
+  const int ax1 = a.origin.x + a.size.w;
+  const int bx1 = b.origin.x + b.size.w;
+  const int ay1 = a.origin.y + a.size.h;
+  const int by1 = b.origin.y + b.size.h;
+  const int x1 = (ax1 < bx1) ? ax1 : bx1;
+  const int y1 = (ay1 < by1) ? ay1 : by1;
+  if (x1 <= x0 || y1 <= y0) {
+    return GRect(x0, y0, 0, 0);
+  }
+  return GRect(x0, y0, x1 - x0, y1 - y0);
+}
+
+/* On 1-bit displays anything lighter than mid grey is white. The firmware
+ * dithers greys instead; the engine never draws any there. */
+static inline bool prv_is_white(GColor color) {
+  return (color.r + color.g + color.b) >= 6;
+}
+
+static inline bool prv_is_1bit(const GBitmap *bitmap) {
+  return bitmap->format == GBitmapFormat1Bit;
+}
+
+static inline GColor prv_read(const GBitmap *bitmap, int x, int y) {
+  const uint8_t *row = bitmap->data + (y * bitmap->stride);
+  if (prv_is_1bit(bitmap)) {
+    return (row[x / 8] & (1 << (x % 8))) ? GColorWhite : GColorBlack;
+  }
+  return (GColor){.argb = row[x]};
+}
+
+static inline void prv_write(GBitmap *bitmap, int x, int y, GColor color) {
+  uint8_t *row = bitmap->data + (y * bitmap->stride);
+  if (prv_is_1bit(bitmap)) {
+    const uint8_t bit = (uint8_t)(1 << (x % 8));
+    if (prv_is_white(color)) {
+      row[x / 8] |= bit;
+    } else {
+      row[x / 8] &= (uint8_t)~bit;
+    }
+  } else {
+    row[x] = color.argb;
+  }
+}
+
+/* Bitmaps */
+
+static uint16_t prv_stride(GSize size, GBitmapFormat format) {
+  /* 1-bit rows are padded to whole words, as in the SDK */
+  return (format == GBitmapFormat1Bit) ? (uint16_t)(((size.w + 31) / 32) * 4)
+                                       : (uint16_t)size.w;
+}
+
+GBitmap *gbitmap_create_blank(GSize size, GBitmapFormat format) {
+  if (s_host.bitmap_alloc_fails || size.w <= 0 || size.h <= 0 ||
+      (format != GBitmapFormat1Bit && format != GBitmapFormat8Bit)) {
+    return NULL;
+  }
+
+  GBitmap *bitmap = calloc(1, sizeof(*bitmap));
+  if (!bitmap) {
+    return NULL;
+  }
+  bitmap->stride = prv_stride(size, format);
+  bitmap->data = calloc(size.h, bitmap->stride);
+  if (!bitmap->data) {
+    free(bitmap);
+    return NULL;
+  }
+  bitmap->format = format;
+  bitmap->bounds = GRect(0, 0, size.w, size.h);
+  bitmap->data_size = size;
+  bitmap->owns_data = true;
+  return bitmap;
+}
+
+static inline uint16_t prv_get_u16(const uint8_t *data) {
+  return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+GBitmap *gbitmap_create_with_data(const uint8_t *data) {
+  /* row size, info flags, then the bounds as x, y, w, h */
+  const uint16_t flags = prv_get_u16(data + 2);
+  const GBitmapFormat format = (GBitmapFormat)((flags >> 1) & 0x1F);
+  const GSize size = GSize(prv_get_u16(data + 8), prv_get_u16(data + 10));
+  if (s_host.bitmap_alloc_fails || (flags >> 12) != 1 || size.w <= 0 || size.h <= 0 ||
+      (format != GBitmapFormat1Bit && format != GBitmapFormat8Bit) ||
+      prv_get_u16(data) != prv_stride(size, format)) {
+    return NULL;
+  }
+
+  GBitmap *bitmap = calloc(1, sizeof(*bitmap));
+  if (!bitmap) {
+    return NULL;
+  }
+  bitmap->data = (uint8_t *)data + 12;
+  bitmap->stride = prv_stride(size, format);
+  bitmap->format = format;
+  bitmap->bounds = GRect(0, 0, size.w, size.h);
+  bitmap->data_size = size;
+  bitmap->owns_data = false;
+  return bitmap;
+}
+
+GBitmap *gbitmap_create_as_sub_bitmap(const GBitmap *base_bitmap, GRect sub_rect) {
+  if (!base_bitmap || s_host.bitmap_alloc_fails) {
+    return NULL;
+  }
+
+  GBitmap *bitmap = calloc(1, sizeof(*bitmap));
+  if (!bitmap) {
+    return NULL;
+  }
+  *bitmap = *base_bitmap;
+  bitmap->bounds = prv_intersect(base_bitmap->bounds, sub_rect);
+  bitmap->owns_data = false;
+  return bitmap;
+}
+
+void gbitmap_destroy(GBitmap *bitmap) {
+  if (!bitmap || bitmap == &s_host.framebuffer) {
+    return;
+  }
+  if (bitmap->owns_data) {
+    free(bitmap->data);
+  }
+  free(bitmap);
+}
+
+uint8_t *gbitmap_get_data(const GBitmap *bitmap) {
+  return bitmap ? bitmap->data : NULL;
+}
+
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap) {
+  return bitmap ? bitmap->stride : 0;
+}
+
+GBitmapFormat gbitmap_get_format(const GBitmap *bitmap) {
+  return bitmap ? bitmap->format : GBitmapFormat1Bit;
+}
+
+GRect gbitmap_get_bounds(const GBitmap *bitmap) {
+  return bitmap ? bitmap->bounds : GRectZero;
+}
+
+void gbitmap_set_bounds(GBitmap *bitmap, GRect bounds) {
+  if (bitmap) {
+    bitmap->bounds = bounds;
+  }
+}
+
+GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap *bitmap, uint16_t y) {
+  GBitmapDataRowInfo info = {
+    .data = bitmap->data + (y * bitmap->stride),
+    .min_x = 0,
+    .max_x = (int16_t)(bitmap->data_size.w - 1),
+  };
+  if (bitmap->format == GBitmapFormat8BitCircular) {
+    info.min_x = s_host.row_min_x[y];
+    info.max_x = s_host.row_max_x[y];
+  }
+  return info;
+}
+
+/* Framebuffer */
+
+/* The round display shows the pixels whose centres lie within the circle
+ * through the middle of its edges. That is close to the firmware's mask but
+ * not taken from it, so chalk frames can differ from the watch in the
+ * outermost pixel of a row. */
+static void prv_init_framebuffer(void) {
+  GBitmap *fb = &s_host.framebuffer;
+  *fb = (GBitmap){
+    .data = s_host.framebuffer_data,
+    .format = PBL_IF_ROUND_ELSE(GBitmapFormat8BitCircular,
+                                PBL_IF_COLOR_ELSE(GBitmapFormat8Bit, GBitmapFormat1Bit)),
+    .bounds = GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT),
+    .data_size = GSize(PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT),
+  };
+  fb->stride = prv_stride(fb->data_size, fb->format);
+  memset(s_host.framebuffer_data, 0, sizeof(s_host.framebuffer_data));
+
+  s_host.visible_pixels = 0;
+  for (int y = 0; y < PBL_DISPLAY_HEIGHT; ++y) {
+    int min_x = 0;
+    int max_x = PBL_DISPLAY_WIDTH - 1;
+#if defined(PBL_ROUND)
+    const int dy = (2 * y) + 1 - PBL_DISPLAY_HEIGHT;
+    const int radius = PBL_DISPLAY_WIDTH;
+    while (min_x <= max_x) {
+      const int dx = (2 * min_x) + 1 - PBL_DISPLAY_WIDTH;
+      if ((dx * dx) + (dy * dy) <= radius * radius) {
+        break;
+      }
+      ++min_x;
+    }
+    max_x = PBL_DISPLAY_WIDTH - 1 - min_x;
+#endif
+    s_host.row_min_x[y] = (int16_t)min_x;
+    s_host.row_max_x[y] = (int16_t)max_x;
+    if (max_x >= min_x) {
+      s_host.visible_pixels += (uint32_t)(max_x - min_x + 1);
+    }
+  }
+}
+
+bool roundy_host_pixel_visible(int x, int y) {
+  return x >= 0 && y >= 0 && x < PBL_DISPLAY_WIDTH && y < PBL_DISPLAY_HEIGHT &&
+         x >= s_host.row_min_x[y] && x <= s_host.row_max_x[y];
+}
+
+GColor roundy_host_get_pixel(const GBitmap *bitmap, int x, int y) {
+  if (bitmap == &s_host.framebuffer && !roundy_host_pixel_visible(x, y)) {
+    return GColorBlack;
+  }
+  return prv_read(bitmap, x, y);
+}
+
+/* Graphics */
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color) {
+  ctx->fill = color;
+}
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color) {
+  ctx->stroke = color;
+}
+
+void graphics_context_set_compositing_mode(GContext *ctx, GCompOp mode) {
+  ctx->comp_op = mode;
+}
+
+static inline void prv_count(GContext *ctx, uint32_t pixel_writes) {
+  if (ctx->section) {
+    ctx->section->draw_calls++;
+    ctx->section->pixel_writes += pixel_writes;
+    prv_frame_stats()->draw_calls++;
+    prv_frame_stats()->pixel_writes += pixel_writes;
+  }
+}
+
+/* `rect` in the drawing layer's coordinates, clipped to what can be drawn. */
+static GRect prv_clip(GContext *ctx, GRect rect) {
+  rect.origin.x += ctx->offset.x;
+  rect.origin.y += ctx->offset.y;
+  return prv_intersect(rect, ctx->clip);
+}
+
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius,
+                        GCornerMask corner_mask) {
+  (void)corner_radius;
+  (void)corner_mask;
+  if (ctx->captured) {
+    return;
+  }
+
+  const GRect area = prv_clip(ctx, rect);
+  uint32_t written = 0;
+  if (ctx->fill.a != 0) {
+    for (int y = area.origin.y; y < area.origin.y + area.size.h; ++y) {
+      const int min_x = (area.origin.x > s_host.row_min_x[y]) ? area.origin.x
+                                                               : s_host.row_min_x[y];
+      const int end_x = area.origin.x + area.size.w;
+      const int max_x = (end_x - 1 < s_host.row_max_x[y]) ? end_x - 1 : s_host.row_max_x[y];
+      for (int x = min_x; x <= max_x; ++x) {
+        prv_write(ctx->dest, x, y, ctx->fill);
+        ++written;
+      }
+    }
+  }
+  prv_count(ctx, written);
+}
+
+void graphics_draw_pixel(GContext *ctx, GPoint point) {
+  if (ctx->captured) {
+    return;
+  }
+
+  const GRect area = prv_clip(ctx, GRect(point.x, point.y, 1, 1));
+  uint32_t written = 0;
+  if (area.size.w > 0 && ctx->stroke.a != 0 &&
+      roundy_host_pixel_visible(area.origin.x, area.origin.y)) {
+    prv_write(ctx->dest, area.origin.x, area.origin.y, ctx->stroke);
+    written = 1;
+  }
+  prv_count(ctx, written);
+}
+
+/* Combines a source pixel with the destination; returns false to leave the
+ * destination as it is. */
+static inline bool prv_composite(GCompOp op, const GBitmap *src, GColor source,
+                                 GColor dest, GColor *out) {
+  if (!prv_is_1bit(src) && !prv_is_1bit(&s_host.framebuffer)) {
+    /* colour bitmaps are either copied or drawn where they are opaque */
+    if (op == GCompOpSet && source.a == 0) {
+      return false;
+    }
+    *out = source;
+    return true;
+  }
+
+  const bool s = prv_is_white(source);
+  const bool d = prv_is_white(dest);
+  bool white;
+  switch (op) {
+    case GCompOpAssignInverted:
+      white = !s;
+      break;
+    case GCompOpOr:
+    case GCompOpSet:
+      white = d || s;
+      break;
+    case GCompOpAnd:
+      white = d && s;
+      break;
+    case GCompOpClear:
+      white = d && !s;
+      break;
+    case GCompOpAssign:
+    default:
+      white = s;
+      break;
+  }
+  *out = white ? GColorWhite : GColorBlack;
+  return true;
+}
+
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect) {
+  if (ctx->captured || !bitmap) {
+    return;
+  }
+
+  /* the bitmap's bounds are tiled over `rect` */
+  const GRect src = bitmap->bounds;
+  const GPoint origin = GPoint(rect.origin.x + ctx->offset.x, rect.origin.y + ctx->offset.y);
+  const GRect area = prv_clip(ctx, rect);
+  /* copying colour rows is by far the most common case; keep it cheap so
+   * that the wall times measure the engine rather than this file */
+  const bool copy = !prv_is_1bit(bitmap) && !prv_is_1bit(ctx->dest) &&
+                    ctx->comp_op != GCompOpSet;
+  const bool copy_bits = prv_is_1bit(bitmap) && prv_is_1bit(ctx->dest) &&
+                         ctx->comp_op == GCompOpAssign;
+  uint32_t written = 0;
+  if (src.size.w > 0 && src.size.h > 0) {
+    for (int y = area.origin.y; y < area.origin.y + area.size.h; ++y) {
+      const int sy = src.origin.y + ((y - origin.y) % src.size.h);
+      const int min_x = (area.origin.x > s_host.row_min_x[y]) ? area.origin.x
+                                                               : s_host.row_min_x[y];
+      const int end_x = area.origin.x + area.size.w;
+      const int max_x = (end_x - 1 < s_host.row_max_x[y]) ? end_x - 1 : s_host.row_max_x[y];
+      int sx = src.origin.x + ((min_x - origin.x) % src.size.w);
+      if (copy) {
+        const uint8_t *src_row = bitmap->data + (sy * bitmap->stride);
+        uint8_t *dest_row = ctx->dest->data + (y * ctx->dest->stride);
+        for (int x = min_x; x <= max_x; ++x) {
+          dest_row[x] = src_row[sx];
+          if (++sx == src.origin.x + src.size.w) {
+            sx = src.origin.x;
+          }
+        }
+        written += (max_x >= min_x) ? (uint32_t)(max_x - min_x + 1) : 0;
+        continue;
+      }
+      if (copy_bits) {
+        const uint8_t *src_row = bitmap->data + (sy * bitmap->stride);
+        uint8_t *dest_row = ctx->dest->data + (y * ctx->dest->stride);
+        for (int x = min_x; x <= max_x; ++x) {
+          const uint8_t bit = (uint8_t)(1 << (x % 8));
+          if (src_row[sx / 8] & (1 << (sx % 8))) {
+            dest_row[x / 8] |= bit;
+          } else {
+            dest_row[x / 8] &= (uint8_t)~bit;
+          }
+          if (++sx == src.origin.x + src.size.w) {
+            sx = src.origin.x;
+          }
+        }
+        written += (max_x >= min_x) ? (uint32_t)(max_x - min_x + 1) : 0;
+        continue;
+      }
+      for (int x = min_x; x <= max_x; ++x) {
+        GColor color;
+        if (prv_composite(ctx->comp_op, bitmap, prv_read(bitmap, sx, sy),
+                          prv_read(ctx->dest, x, y), &color)) {
+          prv_write(ctx->dest, x, y, color);
+          ++written;
+        }
+        if (++sx == src.origin.x + src.size.w) {
+          sx = src.origin.x;
+        }
+      }
+    }
+  }
+  prv_count(ctx, written);
+}
+
+GBitmap *graphics_capture_frame_buffer(GContext *ctx) {
+  if (ctx->captured) {
+    return NULL;
+  }
+  ctx->captured = true;
+  /* whoever captures the framebuffer is assumed to rewrite all of it */
+  prv_count(ctx, s_host.visible_pixels);
+  return ctx->dest;
+}
+
+GBitmap *graphics_capture_frame_buffer_format(GContext *ctx, GBitmapFormat format) {
+  return (format == ctx->dest->format) ? graphics_capture_frame_buffer(ctx) : NULL;
+}
+
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer) {
+  if (!ctx->captured || buffer != ctx->dest) {
+    return false;
+  }
+  ctx->captured = false;
+  return true;
+}
+
+/* Layers */
+
+Layer *layer_create(GRect frame) {
+  return layer_create_with_data(frame, 0);
+}
+
+Layer *layer_create_with_data(GRect frame, size_t data_size) {
+  Layer *layer = calloc(1, sizeof(*layer));
+  if (!layer) {
+    return NULL;
+  }
+  if (data_size) {
+    layer->data = calloc(1, data_size);
+    if (!layer->data) {
+      free(layer);
+      return NULL;
+    }
+  }
+  layer->frame = frame;
+  layer->bounds = GRect(0, 0, frame.size.w, frame.size.h);
+  return layer;
+}
+
+void layer_destroy(Layer *layer) {
+  if (!layer) {
+    return;
+  }
+  layer_remove_from_parent(layer);
+  for (Layer *child = layer->first_child; child;) {
+    Layer *next = child->next_sibling;
+    child->parent = NULL;
+    child->next_sibling = NULL;
+    child = next;
+  }
+  free(layer->data);
+  free(layer);
+}
+
+void *layer_get_data(const Layer *layer) {
+  return layer ? layer->data : NULL;
+}
+
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc) {
+  layer->update_proc = update_proc;
+}
+
+void layer_mark_dirty(Layer *layer) {
+  (void)layer;
+  s_host.dirty = true;
+}
+
+GRect layer_get_frame(const Layer *layer) {
+  return layer->frame;
+}
+
+void layer_set_frame(Layer *layer, GRect frame) {
+  /* bounds that matched the frame keep matching it */
+  if (layer->bounds.origin.x == 0 && layer->bounds.origin.y == 0 &&
+      layer->bounds.size.w == layer->frame.size.w &&
+      layer->bounds.size.h == layer->frame.size.h) {
+    layer->bounds.size = frame.size;
+  }
+  layer->frame = frame;
+  s_host.dirty = true;
+}
+
+GRect layer_get_bounds(const Layer *layer) {
+  return layer->bounds;
+}
+
+void layer_set_bounds(Layer *layer, GRect bounds) {
+  layer->bounds = bounds;
+  s_host.dirty = true;
+}
+
+void layer_add_child(Layer *parent, Layer *child) {
+  if (!parent || !child) {
+    return;
+  }
+  layer_remove_from_parent(child);
+  child->parent = parent;
+  Layer **link = &parent->first_child;
+  while (*link) {
+    link = &(*link)->next_sibling;
+  }
+  *link = child;
+  s_host.dirty = true;
+}
+
+void layer_remove_from_parent(Layer *child) {
+  if (!child || !child->parent) {
+    return;
+  }
+  for (Layer **link = &child->parent->first_child; *link; link = &(*link)->next_sibling) {
+    if (*link == child) {
+      *link = child->next_sibling;
+      break;
+    }
+  }
+  child->parent = NULL;
+  child->next_sibling = NULL;
+  s_host.dirty = true;
+}
+
+void layer_set_hidden(Layer *layer, bool hidden) {
+  layer->hidden = hidden;
+  s_host.dirty = true;
+}
+
+bool layer_get_hidden(const Layer *layer) {
+  return layer->hidden;
+}
+
+/* Drawing the layer tree */
+
+static RoundyHostStats *prv_section(const char *name) {
+  for (int i = 0; i < s_host.section_count; ++i) {
+    if (strcmp(s_host.stats[i].name, name) == 0) {
+      return &s_host.stats[i];
+    }
+  }
+  if (s_host.section_count == ROUNDY_HOST_MAX_SECTIONS) {
+    return NULL;
+  }
+  RoundyHostStats *stats = &s_host.stats[s_host.section_count++];
+  *stats = (RoundyHostStats){.name = name};
+  return stats;
+}
+
+static void prv_draw_layer(Layer *layer, GPoint parent_origin, GRect clip,
+                           RoundyHostStats *section) {
+  if (layer->hidden) {
+    return;
+  }
+
+  const GRect frame = GRect(parent_origin.x + layer->frame.origin.x,
+                            parent_origin.y + layer->frame.origin.y, layer->frame.size.w,
+                            layer->frame.size.h);
+  clip = prv_intersect(clip, frame);
+  const GPoint origin =
+      GPoint(frame.origin.x + layer->bounds.origin.x, frame.origin.y + layer->bounds.origin.y);
+  if (layer->name) {
+    section = prv_section(layer->name);
+  }
+
+  if (layer->update_proc) {
+    GContext ctx = {
+      .dest = &s_host.framebuffer,
+      .offset = origin,
+      .clip = clip,
+      .fill = GColorBlack,
+      .stroke = GColorBlack,
+      .comp_op = GCompOpAssign,
+      .section = section,
+    };
+    const uint64_t start_ns = prv_monotonic_ns();
+    const uint64_t start_cycles = prv_cycles();
+    layer->update_proc(layer, &ctx);
+    if (section) {
+      section->cycles += prv_cycles() - start_cycles;
+      section->wall_ns += prv_monotonic_ns() - start_ns;
+      /* several layers of one section make one frame of it */
+      const uint32_t index = (uint32_t)(section - s_host.stats);
+      if (s_host.stats_frame[index] != s_host.frame_index) {
+        s_host.stats_frame[index] = s_host.frame_index;
+        section->frames++;
+      }
+    }
+  }
+
+  for (Layer *child = layer->first_child; child; child = child->next_sibling) {
+    prv_draw_layer(child, origin, clip, section);
+  }
+}
+
+bool roundy_host_draw_if_dirty(void) {
+  if (!s_host.dirty || !s_host.root) {
+    return false;
+  }
+
+  /* marks made while drawing ask for the next frame */
+  s_host.dirty = false;
+  s_host.frame_index++;
+  const uint64_t start_ns = prv_monotonic_ns();
+  const uint64_t start_cycles = prv_cycles();
+  /* the window clears the framebuffer first, which no update_proc pays for */
+  const bool white = prv_is_white(s_host.background);
+  memset(s_host.framebuffer_data,
+         prv_is_1bit(&s_host.framebuffer) ? (white ? 0xFF : 0x00) : s_host.background.argb,
+         sizeof(s_host.framebuffer_data));
+  prv_draw_layer(s_host.root, GPointZero, s_host.framebuffer.bounds, NULL);
+  RoundyHostStats *frame = prv_frame_stats();
+  frame->cycles += prv_cycles() - start_cycles;
+  frame->wall_ns += prv_monotonic_ns() - start_ns;
+  frame->frames++;
+  if (s_host.frame_handler) {
+    s_host.frame_handler(&s_host.framebuffer, s_host.frame_handler_context);
+  }
+  return true;
+}
+
+/* Timers and time */
+
+/* Keeps the timers sorted by deadline; timers with the same deadline fire in
+ * the order they were scheduled. */
+static void prv_insert_timer(HostTimer *timer) {
+  HostTimer **link = &s_host.timers;
+  while (*link && (*link)->deadline_ms <= timer->deadline_ms) {
+    link = &(*link)->next;
+  }
+  timer->next = *link;
+  *link = timer;
+}
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback,
+                             void *callback_data) {
+  HostTimer *timer = calloc(1, sizeof(*timer));
+  if (!timer) {
+    return NULL;
+  }
+  *timer = (HostTimer){
+    .id = ++s_host.next_timer_id,
+    .deadline_ms = s_host.now_ms + timeout_ms,
+    .callback = callback,
+    .data = callback_data,
+  };
+  prv_insert_timer(timer);
+  return (AppTimer *)timer->id;
+}
+
+static HostTimer *prv_unlink_timer(AppTimer *timer_handle) {
+  for (HostTimer **link = &s_host.timers; *link; link = &(*link)->next) {
+    if ((AppTimer *)(*link)->id == timer_handle) {
+      HostTimer *timer = *link;
+      *link = timer->next;
+      return timer;
+    }
+  }
+  return NULL;
+}
+
+bool app_timer_reschedule(AppTimer *timer_handle, uint32_t new_timeout_ms) {
+  HostTimer *timer = prv_unlink_timer(timer_handle);
+  if (!timer) {
+    return false;
+  }
+  timer->deadline_ms = s_host.now_ms + new_timeout_ms;
+  prv_insert_timer(timer);
+  return true;
+}
+
+void app_timer_cancel(AppTimer *timer_handle) {
+  free(prv_unlink_timer(timer_handle));
+}
+
+static bool prv_fire_next(uint64_t until_ms) {
+  HostTimer *timer = s_host.timers;
+  if (!timer || timer->deadline_ms > until_ms) {
+    return false;
+  }
+
+  s_host.timers = timer->next;
+  if (timer->deadline_ms > s_host.now_ms) {
+    s_host.now_ms = timer->deadline_ms;
+  }
+  const AppTimerCallback callback = timer->callback;
+  void *data = timer->data;
+  free(timer);
+  /* the events that lead to a frame are part of its cost */
+  const uint64_t start_ns = prv_monotonic_ns();
+  const uint64_t start_cycles = prv_cycles();
+  callback(data);
+  prv_frame_stats()->cycles += prv_cycles() - start_cycles;
+  prv_frame_stats()->wall_ns += prv_monotonic_ns() - start_ns;
+  return true;
+}
+
+int roundy_host_run_for(uint32_t duration_ms) {
+  const uint64_t end_ms = s_host.now_ms + duration_ms;
+  int frames = roundy_host_draw_if_dirty() ? 1 : 0;
+  while (prv_fire_next(end_ms)) {
+    frames += roundy_host_draw_if_dirty() ? 1 : 0;
+  }
+  s_host.now_ms = end_ms;
+  return frames;
+}
+
+int roundy_host_run_until_idle(uint32_t limit_ms) {
+  const uint64_t end_ms = s_host.now_ms + limit_ms;
+  int frames = roundy_host_draw_if_dirty() ? 1 : 0;
+  while (prv_fire_next(end_ms)) {
+    frames += roundy_host_draw_if_dirty() ? 1 : 0;
+  }
+  return frames;
+}
+
+bool roundy_host_has_timers(void) {
+  return s_host.timers != NULL;
+}
+
+uint64_t roundy_host_now_ms(void) {
+  return s_host.now_ms;
+}
+
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms) {
+  const uint16_t ms = (uint16_t)(s_host.now_ms % 1000);
+  if (tloc) {
+    *tloc = (time_t)(s_host.now_ms / 1000);
+  }
+  if (out_ms) {
+    *out_ms = ms;
+  }
+  return ms;
+}
+
+time_t roundy_host_time(time_t *tloc) {
+  const time_t now = (time_t)(s_host.now_ms / 1000);
+  if (tloc) {
+    *tloc = now;
+  }
+  return now;
+}
+
+static TickHandler s_tick_handler;
+
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler) {
+  (void)tick_units;
+  s_tick_handler = handler;
+}
+
+void tick_timer_service_unsubscribe(void) {
+  s_tick_handler = NULL;
+}
+
+bool clock_is_24h_style(void) {
+  return s_host.is_24h;
+}
+
+/* Logging */
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number,
+             const char *fmt, ...) {
+  if (log_level > s_host.log_level) {
+    return;
+  }
+  va_list args;
+  va_start(args, fmt);
+  fprintf(stderr, "%s:%d: ", src_filename, src_line_number);
+  vfprintf(stderr, fmt, args);
+  fputc('\n', stderr);
+  va_end(args);
+}
+
+/* Persistent storage */
+
+static HostPersistEntry *prv_persist_entry(uint32_t key) {
+  for (int i = 0; i < HOST_MAX_PERSIST_KEYS; ++i) {
+    if (s_host.persist[i].used && s_host.persist[i].key == key) {
+      return &s_host.persist[i];
+    }
+  }
+  return NULL;
+}
+
+bool persist_exists(const uint32_t key) {
+  return prv_persist_entry(key) != NULL;
+}
+
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size) {
+  const HostPersistEntry *entry = prv_persist_entry(key);
+  if (!entry) {
+    return E_DOES_NOT_EXIST;
+  }
+  const size_t size = (entry->size < buffer_size) ? entry->size : buffer_size;
+  memcpy(buffer, entry->data, size);
+  return (int)size;
+}
+
+int persist_write_data(const uint32_t key, const void *data, const size_t size) {
+  HostPersistEntry *entry = prv_persist_entry(key);
+  for (int i = 0; !entry && i < HOST_MAX_PERSIST_KEYS; ++i) {
+    if (!s_host.persist[i].used) {
+      entry = &s_host.persist[i];
+    }
+  }
+  if (!entry) {
+    return E_OUT_OF_STORAGE;
+  }
+  entry->used = true;
+  entry->key = key;
+  entry->size = (size < PERSIST_DATA_MAX_LENGTH) ? size : PERSIST_DATA_MAX_LENGTH;
+  memcpy(entry->data, data, entry->size);
+  return (int)entry->size;
+}
+
+StatusCode persist_delete(const uint32_t key) {
+  HostPersistEntry *entry = prv_persist_entry(key);
+  if (!entry) {
+    return E_DOES_NOT_EXIST;
+  }
+  entry->used = false;
+  return S_SUCCESS;
+}
+
+/* Services */
+
+BatteryChargeState battery_state_service_peek(void) {
+  return (BatteryChargeState){.charge_percent = 100};
+}
+
+void battery_state_service_subscribe(BatteryStateHandler handler) {
+  (void)handler;
+}
+
+void battery_state_service_unsubscribe(void) {
+}
+
+bool quiet_time_is_active(void) {
+  return false;
+}
+
+bool connection_service_peek_pebble_app_connection(void) {
+  return false;
+}
+
+HealthActivityMask health_service_peek_current_activities(void) {
+  return HealthActivityNone;
+}
+
+bool health_service_events_subscribe(HealthEventHandler handler, void *context) {
+  (void)handler;
+  (void)context;
+  return true;
+}
+
+bool health_service_events_unsubscribe(void) {
+  return true;
+}
+
+/* AppMessage */
+
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key) {
+  (void)iter;
+  (void)key;
+  return NULL;
+}
+
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key,
+                                 const uint8_t *const data, const uint16_t size) {
+  (void)iter;
+  (void)key;
+  (void)data;
+  (void)size;
+  return DICT_OK;
+}
+
+uint32_t dict_calc_buffer_size(const uint8_t tuple_count, ...) {
+  /* a header byte, then a 7 byte header per tuple before its data */
+  uint32_t size = 1 + (7u * tuple_count);
+  va_list sizes;
+  va_start(sizes, tuple_count);
+  for (int i = 0; i < tuple_count; ++i) {
+    size += va_arg(sizes, uint32_t);
+  }
+  va_end(sizes);
+  return size;
+}
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound) {
+  (void)size_inbound;
+  (void)size_outbound;
+  return APP_MSG_OK;
+}
+
+AppMessageInboxReceived app_message_register_inbox_received(
+    AppMessageInboxReceived received_callback) {
+  (void)received_callback;
+  return NULL;
+}
+
+AppMessageOutboxSent app_message_register_outbox_sent(AppMessageOutboxSent sent_callback) {
+  (void)sent_callback;
+  return NULL;
+}
+
+AppMessageOutboxFailed app_message_register_outbox_failed(
+    AppMessageOutboxFailed failed_callback) {
+  (void)failed_callback;
+  return NULL;
+}
+
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator) {
+  (void)iterator;
+  return APP_MSG_NOT_CONNECTED;
+}
+
+AppMessageResult app_message_outbox_send(void) {
+  return APP_MSG_NOT_CONNECTED;
+}
+
+/* Host controls */
+
+void roundy_host_init(time_t now) {
+  /* localtime() of the virtual clock is the time set here */
+  setenv("TZ", "UTC", 1);
+  tzset();
+
+  while (s_host.timers) {
+    HostTimer *timer = s_host.timers;
+    s_host.timers = timer->next;
+    free(timer);
+  }
+  layer_destroy(s_host.root);
+
+  s_host = (RoundyHost){
+    .now_ms = (uint64_t)now * 1000,
+    .is_24h = true,
+    .background = PBL_IF_COLOR_ELSE(GColorBlack, GColorWhite),
+  };
+  s_tick_handler = NULL;
+  prv_section("frame");
+  prv_init_framebuffer();
+  s_host.root = layer_create(GRect(0, 0, PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT));
+  s_host.dirty = true;
+}
+
+Layer *roundy_host_get_root_layer(void) {
+  return s_host.root;
+}
+
+void roundy_host_set_background_color(GColor color) {
+  s_host.background = color;
+  s_host.dirty = true;
+}
+
+void roundy_host_set_24h_style(bool is_24h) {
+  s_host.is_24h = is_24h;
+}
+
+void roundy_host_set_bitmap_alloc_fails(bool fails) {
+  s_host.bitmap_alloc_fails = fails;
+}
+
+void roundy_host_set_log_level(AppLogLevel level) {
+  s_host.log_level = level;
+}
+
+void roundy_host_set_layer_name(Layer *layer, const char *name) {
+  if (layer) {
+    layer->name = name;
+  }
+}
+
+void roundy_host_set_frame_handler(RoundyHostFrameHandler handler, void *context) {
+  s_host.frame_handler = handler;
+  s_host.frame_handler_context = context;
+}
+
+int roundy_host_get_stats(RoundyHostStats stats[ROUNDY_HOST_MAX_SECTIONS]) {
+  memcpy(stats, s_host.stats, sizeof(s_host.stats));
+  return s_host.section_count;
+}
+
+void roundy_host_reset_stats(void) {
+  for (int i = 0; i < s_host.section_count; ++i) {
+    s_host.stats[i] = (RoundyHostStats){.name = s_host.stats[i].name};
+    s_host.stats_frame[i] = 0;
+  }
+}
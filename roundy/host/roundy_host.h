@@ -0,0 +1,81 @@
+#pragma once
+
+#include <pebble.h>
+
+/* Controls of the host stand-in for the Pebble SDK (see pebble.h), for the
+ * programs that drive the engine on a Linux host.
+ *
+ * Nothing runs by itself: roundy_host_run_for() advances the virtual clock,
+ * firing every timer on the way at its deadline, and redraws the layer tree
+ * after each timer that marked a layer dirty, the way the firmware redraws
+ * the window once its pending events are handled. Every redraw measures each
+ * update_proc: wall time, draw calls and pixel writes. */
+
+/* What the update_procs of one section cost, summed over the frames since
+ * the last roundy_host_reset_stats(). */
+typedef struct {
+  const char *name;
+  /* frames in which the section drew */
+  uint32_t frames;
+  /* graphics_* calls that draw, a captured framebuffer counts as one */
+  uint32_t draw_calls;
+  /* pixels those calls wrote after clipping; a captured framebuffer counts
+   * as writing every visible pixel, which is what the engine's direct paths
+   * do */
+  uint64_t pixel_writes;
+  uint64_t wall_ns;
+  /* the processor's cycle counter where the host has one (x86), wall time
+   * in ns elsewhere */
+  uint64_t cycles;
+} RoundyHostStats;
+
+#define ROUNDY_HOST_MAX_SECTIONS 8
+
+typedef void (*RoundyHostFrameHandler)(const GBitmap *framebuffer, void *context);
+
+/* Forgets all layers, timers, persisted data and statistics and sets the
+ * virtual clock to `now`. */
+void roundy_host_init(time_t now);
+/* The full-screen layer the window root would be; add the engine's layers to
+ * it. */
+Layer *roundy_host_get_root_layer(void);
+/* What the window clears the framebuffer with before each redraw. */
+void roundy_host_set_background_color(GColor color);
+void roundy_host_set_24h_style(bool is_24h);
+/* Makes gbitmap_create_blank() fail, to drive the engine's fallbacks for
+ * running out of heap. */
+void roundy_host_set_bitmap_alloc_fails(bool fails);
+/* Passes APP_LOG output at `level` and more severe to stderr; nothing is
+ * logged by default. */
+void roundy_host_set_log_level(AppLogLevel level);
+
+/* Names the section an update_proc is counted in; a layer without a name is
+ * counted in its closest named ancestor's section. */
+void roundy_host_set_layer_name(Layer *layer, const char *name);
+/* Called with the framebuffer after every redraw. */
+void roundy_host_set_frame_handler(RoundyHostFrameHandler handler, void *context);
+
+/* Virtual milliseconds since the epoch. */
+uint64_t roundy_host_now_ms(void);
+/* Runs the timers due in the next `duration_ms` and returns the number of
+ * frames drawn. A pending redraw is drawn first. */
+int roundy_host_run_for(uint32_t duration_ms);
+/* Runs until no timer is pending, at most `limit_ms`; returns the number of
+ * frames drawn. */
+int roundy_host_run_until_idle(uint32_t limit_ms);
+bool roundy_host_has_timers(void);
+/* Redraws the layer tree now if a layer was marked dirty. */
+bool roundy_host_draw_if_dirty(void);
+
+/* Sections in the order they first drew; returns how many there are. The
+ * first one, "frame", is what the frames cost as a whole: the timer
+ * callbacks that led to them, every update_proc and all that they drew. */
+int roundy_host_get_stats(RoundyHostStats stats[ROUNDY_HOST_MAX_SECTIONS]);
+void roundy_host_reset_stats(void);
+
+/* Whether pixel (x, y) of the framebuffer is on the display; only the round
+ * display has pixels that are not. */
+bool roundy_host_pixel_visible(int x, int y);
+/* Colour of pixel (x, y) of `bitmap`; 1-bit pixels come back black or white,
+ * pixels outside a round display black. */
+GColor roundy_host_get_pixel(const GBitmap *bitmap, int x, int y);
@@ -0,0 +1,232 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "roundy_host.h"
+
+#include "roundy_background_layer.h"
+#include "roundy_digit_layer.h"
+#include "roundy_palette.h"
+#if defined(ROUNDY_COMPOSITOR)
+#include "roundy_compositor_layer.h"
+#endif
+
+/* Render benchmark on the host: builds the layers the way roundy_app.c does,
+ * plays the intro and then a run of minute transitions, and prints what each
+ * update_proc cost per frame: wall time, cycles, draw calls and pixel writes.
+ * The "frame" rows add up whole frames, timer callbacks included.
+ *
+ * Draw calls and pixel writes are exact and match the watch. Wall times are
+ * the host's and include the emulated graphics calls, so compare them only
+ * between builds on the same machine.
+ *
+ * Only API that every version of the engine has is used here, so the same
+ * program measures older checkouts too (see ENGINE in the Makefile).
+ *
+ * -b picks the background's drawing path: "grid" makes every bitmap
+ * allocation fail, which leaves the background drawing the grid cell by cell
+ * as it did before it was cached (and the digits without sprites); "cached"
+ * and "direct" need an engine with roundy_background_layer_set_mode().
+ *
+ * usage: roundy_host_bench [-m minutes] [-r repeats] [-s HH:MM] [-12]
+ *                          [-b grid|cached|direct] */
+
+#if !defined(ROUNDY_HOST_PLATFORM)
+#define ROUNDY_HOST_PLATFORM "host"
+#endif
+
+/* 2026-10-17, a Saturday; the host clock runs in UTC */
+#define BENCH_DATE 1792195200
+
+typedef struct {
+  RoundyBackgroundLayer *background;
+  RoundyDigitLayer *digits;
+#if defined(ROUNDY_COMPOSITOR)
+  RoundyCompositorLayer *compositor;
+#endif
+} BenchFace;
+
+typedef enum {
+  BenchBackgroundDefault = 0,
+  BenchBackgroundGrid,
+  BenchBackgroundCached,
+  BenchBackgroundDirect,
+} BenchBackground;
+
+typedef struct {
+  int minutes;
+  int repeats;
+  int start_minute;
+  bool is_24h;
+  BenchBackground background;
+} BenchOptions;
+
+static void prv_face_create(BenchFace *face, BenchBackground background) {
+  Layer *root = roundy_host_get_root_layer();
+  const GRect bounds = layer_get_bounds(root);
+
+  *face = (BenchFace){0};
+  roundy_host_set_background_color(roundy_palette_window_background());
+  face->digits = roundy_digit_layer_create(bounds);
+#if defined(ROUNDY_COMPOSITOR)
+  face->compositor = roundy_compositor_layer_create(bounds, face->digits);
+  if (face->compositor) {
+    Layer *layer = roundy_compositor_layer_get_layer(face->compositor);
+    roundy_host_set_layer_name(layer, "compositor");
+    layer_add_child(root, layer);
+  } else
+#endif
+  {
+    face->background = roundy_background_layer_create(bounds);
+    if (face->background) {
+      Layer *layer = roundy_background_layer_get_layer(face->background);
+      roundy_host_set_layer_name(layer, "background");
+      layer_add_child(root, layer);
+    }
+#if defined(ROUNDY_HOST_BACKGROUND_MODES)
+    if (background == BenchBackgroundCached || background == BenchBackgroundDirect) {
+      roundy_background_layer_set_mode(face->background, (background == BenchBackgroundCached)
+                                                             ? RoundyBackgroundModeCached
+                                                             : RoundyBackgroundModeDirect);
+    }
+#endif
+  }
+  if (face->digits) {
+    Layer *layer = roundy_digit_layer_get_layer(face->digits);
+    roundy_host_set_layer_name(layer, "digits");
+    layer_add_child(root, layer);
+  }
+}
+
+static void prv_face_destroy(BenchFace *face) {
+#if defined(ROUNDY_COMPOSITOR)
+  roundy_compositor_layer_destroy(face->compositor);
+#endif
+  roundy_digit_layer_destroy(face->digits);
+  roundy_background_layer_destroy(face->background);
+  *face = (BenchFace){0};
+}
+
+static void prv_set_time(BenchFace *face) {
+  const time_t now = time(NULL);
+  roundy_digit_layer_set_time(face->digits, localtime(&now));
+}
+
+/* Adds the statistics since the last reset to `totals`. */
+static int prv_collect(RoundyHostStats totals[ROUNDY_HOST_MAX_SECTIONS], int count) {
+  RoundyHostStats stats[ROUNDY_HOST_MAX_SECTIONS];
+  const int sections = roundy_host_get_stats(stats);
+  for (int i = 0; i < sections; ++i) {
+    if (i >= count) {
+      totals[i] = (RoundyHostStats){.name = stats[i].name};
+    }
+    totals[i].frames += stats[i].frames;
+    totals[i].draw_calls += stats[i].draw_calls;
+    totals[i].pixel_writes += stats[i].pixel_writes;
+    totals[i].wall_ns += stats[i].wall_ns;
+    totals[i].cycles += stats[i].cycles;
+  }
+  roundy_host_reset_stats();
+  return (sections > count) ? sections : count;
+}
+
+static void prv_print(const char *scenario, const RoundyHostStats stats[], int count) {
+  for (int i = 0; i < count; ++i) {
+    const RoundyHostStats *s = &stats[i];
+    const double frames = s->frames ? s->frames : 1;
+    printf("%-8s %-8s %-11s %7u %10.1f %12.0f %12.1f %13.1f\n", ROUNDY_HOST_PLATFORM, scenario,
+           s->name, s->frames, (double)s->wall_ns / 1000.0 / frames, (double)s->cycles / frames,
+           s->draw_calls / frames, (double)s->pixel_writes / frames);
+  }
+}
+
+static void prv_run(const BenchOptions *options) {
+  RoundyHostStats intro[ROUNDY_HOST_MAX_SECTIONS];
+  RoundyHostStats minutes[ROUNDY_HOST_MAX_SECTIONS];
+  int intro_count = 0;
+  int minutes_count = 0;
+
+  for (int repeat = 0; repeat < options->repeats; ++repeat) {
+    roundy_host_init(BENCH_DATE + (options->start_minute * 60));
+    roundy_host_set_24h_style(options->is_24h);
+    roundy_host_set_bitmap_alloc_fails(options->background == BenchBackgroundGrid);
+    BenchFace face;
+    prv_face_create(&face, options->background);
+
+    /* the first frame and the diagonal flip that follows it */
+    roundy_digit_layer_refresh_time(face.digits);
+    roundy_digit_layer_start_diag_flip(face.digits);
+    roundy_host_run_until_idle(60 * 1000);
+    intro_count = prv_collect(intro, intro_count);
+
+    for (int minute = 0; minute < options->minutes; ++minute) {
+      roundy_host_run_for(60 * 1000 - (uint32_t)(roundy_host_now_ms() % (60 * 1000)));
+      roundy_host_reset_stats();
+      prv_set_time(&face);
+      roundy_host_run_until_idle(60 * 1000 - 1);
+      minutes_count = prv_collect(minutes, minutes_count);
+    }
+
+    prv_face_destroy(&face);
+  }
+
+  prv_print("intro", intro, intro_count);
+  if (options->minutes > 0) {
+    prv_print("minutes", minutes, minutes_count);
+  }
+}
+
+static bool prv_parse_background(const char *name, BenchBackground *background) {
+  if (strcmp(name, "grid") == 0) {
+    *background = BenchBackgroundGrid;
+    return true;
+  }
+#if defined(ROUNDY_HOST_BACKGROUND_MODES)
+  if (strcmp(name, "cached") == 0) {
+    *background = BenchBackgroundCached;
+    return true;
+  }
+  if (strcmp(name, "direct") == 0) {
+    *background = BenchBackgroundDirect;
+    return true;
+  }
+#endif
+  return false;
+}
+
+int main(int argc, char **argv) {
+  BenchOptions options = {
+    .minutes = 30,
+    .repeats = 5,
+    .start_minute = (9 * 60) + 30,
+    .is_24h = true,
+  };
+  for (int i = 1; i < argc; ++i) {
+    int hour;
+    int minute;
+    if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+      options.minutes = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+      options.repeats = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc &&
+               sscanf(argv[++i], "%d:%d", &hour, &minute) == 2) {
+      options.start_minute = (hour * 60) + minute;
+    } else if (strcmp(argv[i], "-12") == 0) {
+      options.is_24h = false;
+    } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc &&
+               prv_parse_background(argv[++i], &options.background)) {
+    } else {
+      fprintf(stderr,
+              "usage: %s [-m minutes] [-r repeats] [-s HH:MM] [-12] "
+              "[-b grid|cached|direct]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+  if (options.repeats < 1) {
+    options.repeats = 1;
+  }
+
+  printf("%-8s %-8s %-11s %7s %10s %12s %12s %13s\n", "platform", "scenario", "section",
+         "frames", "us/frame", "cycles/frame", "calls/frame", "writes/frame");
+  prv_run(&options);
+  return 0;
+}
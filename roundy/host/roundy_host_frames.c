@@ -0,0 +1,222 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "roundy_host.h"
+
+#include <errno.h>
+#include <sys/stat.h>
+
+#include "roundy_background_layer.h"
+#include "roundy_digit_layer.h"
+#include "roundy_palette.h"
+#if defined(ROUNDY_COMPOSITOR)
+#include "roundy_compositor_layer.h"
+#endif
+
+/* Golden frames on the host: plays the intro and a few minute transitions,
+ * in 24h and in 12h, and writes every frame they draw as
+ * <dir>/<label>/<index>.ppm, or .pgm on 1-bit displays, the layout
+ * tools/roundy_frames.py compares.
+ *
+ * Like roundy_host_bench.c this only uses API that every version of the
+ * engine has, so the reference frames can come from another checkout (see
+ * ENGINE and `make golden` in the Makefile).
+ *
+ * -t picks the transition theme, for engines with roundy_palette_set_theme().
+ *
+ * usage: roundy_host_frames [-t mono|ember|ocean] -o dir, where the parent of
+ *        dir exists */
+
+/* 2026-10-17 00:00 in the host's UTC */
+#define FRAMES_DATE 1792195200
+#define DAY_MINUTES (24 * 60)
+/* longer than any animation the face plays */
+#define FRAMES_IDLE_LIMIT_MS (60 * 1000)
+
+/* The transitions that change several glyphs at once, plus an ordinary one;
+ * each entry is the minute transitioned to. */
+static const int16_t s_golden_minutes[] = {
+  0,       /* 23:59 -> 00:00, 11:59 -> 12:00 in 12h mode */
+  1,       /* 00:00 -> 00:01 */
+  10 * 60, /* 09:59 -> 10:00 */
+  12 * 60, /* 11:59 -> 12:00 */
+  13 * 60, /* 12:59 -> 13:00, the leading digit disappears in 12h mode */
+  20 * 60, /* 19:59 -> 20:00 */
+};
+
+typedef struct {
+  const char *dir;
+  /* frames are written while a label is set */
+  char label[32];
+  bool recording;
+  int index;
+} FramesOutput;
+
+static FramesOutput s_output;
+
+#if defined(ROUNDY_HOST_PALETTE_THEMES)
+static const char *const s_theme_names[] = {"mono", "ember", "ocean"};
+_Static_assert(ARRAY_LENGTH(s_theme_names) == RoundyPaletteThemeCount, "one name per theme");
+
+static RoundyPaletteTheme s_theme = RoundyPaletteThemeMono;
+
+static bool prv_parse_theme(const char *name) {
+  for (int i = 0; i < RoundyPaletteThemeCount; ++i) {
+    if (strcmp(name, s_theme_names[i]) == 0) {
+      s_theme = (RoundyPaletteTheme)i;
+      return true;
+    }
+  }
+  return false;
+}
+#endif
+
+static void prv_make_dir(const char *path) {
+  if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+    fprintf(stderr, "cannot create %s: %s\n", path, strerror(errno));
+    exit(1);
+  }
+}
+
+static void prv_write_frame(const GBitmap *framebuffer, void *context) {
+  (void)context;
+  if (!s_output.recording) {
+    return;
+  }
+
+  const GRect bounds = gbitmap_get_bounds(framebuffer);
+  const bool is_1bit = gbitmap_get_format(framebuffer) == GBitmapFormat1Bit;
+  char path[512];
+  snprintf(path, sizeof(path), "%s/%s/%04d.%s", s_output.dir, s_output.label,
+           s_output.index++, is_1bit ? "pgm" : "ppm");
+  FILE *file = fopen(path, "wb");
+  if (!file) {
+    fprintf(stderr, "cannot write %s: %s\n", path, strerror(errno));
+    exit(1);
+  }
+
+  /* what tools/roundy_frames.py writes: 1-bit pixels are 0 or 255, colour
+   * channels the two GColor8 bits times 85 */
+  fprintf(file, "%s\n%d %d\n255\n", is_1bit ? "P5" : "P6", bounds.size.w, bounds.size.h);
+  for (int y = 0; y < bounds.size.h; ++y) {
+    for (int x = 0; x < bounds.size.w; ++x) {
+      const GColor color = roundy_host_get_pixel(framebuffer, x, y);
+      if (is_1bit) {
+        fputc(gcolor_equal(color, GColorWhite) ? 255 : 0, file);
+      } else {
+        fputc(color.r * 85, file);
+        fputc(color.g * 85, file);
+        fputc(color.b * 85, file);
+      }
+    }
+  }
+  fclose(file);
+}
+
+static void prv_record(const char *label) {
+  snprintf(s_output.label, sizeof(s_output.label), "%s", label);
+  char path[512];
+  snprintf(path, sizeof(path), "%s/%s", s_output.dir, label);
+  prv_make_dir(path);
+  s_output.recording = true;
+  s_output.index = 0;
+}
+
+static void prv_stop(void) {
+  s_output.recording = false;
+}
+
+/* Runs the clock to the start of `minute` of FRAMES_DATE, a negative minute
+ * being one of the day before, and shows it. */
+static void prv_set_minute(RoundyDigitLayer *digits, int minute) {
+  const uint64_t target_ms = ((uint64_t)FRAMES_DATE + (int64_t)minute * 60) * 1000;
+  roundy_host_run_for((uint32_t)(target_ms - roundy_host_now_ms()));
+  const time_t now = time(NULL);
+  roundy_digit_layer_set_time(digits, localtime(&now));
+  roundy_host_run_until_idle(FRAMES_IDLE_LIMIT_MS);
+}
+
+static void prv_play(bool is_24h) {
+  const char *format = is_24h ? "24h" : "12h";
+  /* the intro starts at 23:59 of the day before */
+  roundy_host_init(FRAMES_DATE - 60);
+  roundy_host_set_24h_style(is_24h);
+  roundy_host_set_frame_handler(prv_write_frame, NULL);
+
+  Layer *root = roundy_host_get_root_layer();
+  const GRect bounds = layer_get_bounds(root);
+  roundy_host_set_background_color(roundy_palette_window_background());
+#if defined(ROUNDY_HOST_PALETTE_THEMES)
+  /* before the layer paints its cell sprites, as roundy_app.c does */
+  roundy_palette_set_theme(s_theme);
+#endif
+  RoundyDigitLayer *digits = roundy_digit_layer_create(bounds);
+  RoundyBackgroundLayer *background = NULL;
+#if defined(ROUNDY_COMPOSITOR)
+  RoundyCompositorLayer *compositor = roundy_compositor_layer_create(bounds, digits);
+  if (compositor) {
+    layer_add_child(root, roundy_compositor_layer_get_layer(compositor));
+  } else
+#endif
+  {
+    background = roundy_background_layer_create(bounds);
+    layer_add_child(root, roundy_background_layer_get_layer(background));
+  }
+  layer_add_child(root, roundy_digit_layer_get_layer(digits));
+
+  /* the intro only once, it does not depend on the format */
+  if (is_24h) {
+    prv_record("24h-intro");
+  }
+  roundy_digit_layer_refresh_time(digits);
+  roundy_digit_layer_start_diag_flip(digits);
+  roundy_host_run_until_idle(FRAMES_IDLE_LIMIT_MS);
+  prv_stop();
+
+  /* the intro showed 23:59 */
+  int shown = -1;
+  for (size_t i = 0; i < ARRAY_LENGTH(s_golden_minutes); ++i) {
+    const int minute = s_golden_minutes[i];
+    const int from = (minute == 0) ? -1 : minute - 1;
+    if (shown != from) {
+      prv_set_minute(digits, from);
+    }
+    char label[32];
+    snprintf(label, sizeof(label), "%s-%02d%02d-%02d%02d", format,
+             ((from + DAY_MINUTES) % DAY_MINUTES) / 60, ((from + DAY_MINUTES) % DAY_MINUTES) % 60,
+             minute / 60, minute % 60);
+    prv_record(label);
+    prv_set_minute(digits, minute);
+    prv_stop();
+    shown = minute;
+  }
+
+#if defined(ROUNDY_COMPOSITOR)
+  roundy_compositor_layer_destroy(compositor);
+#endif
+  roundy_digit_layer_destroy(digits);
+  roundy_background_layer_destroy(background);
+}
+
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      s_output.dir = argv[++i];
+#if defined(ROUNDY_HOST_PALETTE_THEMES)
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc && prv_parse_theme(argv[i + 1])) {
+      ++i;
+#endif
+    } else {
+      s_output.dir = NULL;
+      break;
+    }
+  }
+  if (!s_output.dir) {
+    fprintf(stderr, "usage: %s [-t mono|ember|ocean] -o dir\n", argv[0]);
+    return 2;
+  }
+
+  prv_make_dir(s_output.dir);
+  prv_play(true);
+  prv_play(false);
+  return 0;
+}
@@ -0,0 +1,175 @@
+// Checks the settings channel of src/pkjs under Node, with stand-ins for
+// Pebble and localStorage: the bytes sent to the watch, which must match
+// what src/c/roundy_settings.c decodes, and that whatever the configuration
+// page returns is clamped to what the watch accepts.
+//
+//   node settings_test.js [path to src/pkjs]
+
+const assert = require('assert');
+const path = require('path');
+
+const PKJS_DIR = path.resolve(process.argv[2] || path.join(__dirname, '..', 'src', 'pkjs'));
+
+function createStorage() {
+  const items = {};
+  return {
+    items,
+    getItem: (key) => (key in items ? items[key] : null),
+    setItem: (key, value) => {
+      items[key] = String(value);
+    },
+  };
+}
+
+// Records every message; `fail` makes the sends fail with that event.
+function createPebble(fail) {
+  const pebble = {
+    handlers: {},
+    sent: [],
+    addEventListener: (type, handler) => {
+      pebble.handlers[type] = handler;
+    },
+    sendAppMessage: (message, success, failure) => {
+      pebble.sent.push(message);
+      if (fail) {
+        failure(fail);
+      } else {
+        success({});
+      }
+    },
+  };
+  return pebble;
+}
+
+const tests = [];
+function test(name, run) {
+  tests.push({ name, run });
+}
+
+const settings = require(path.join(PKJS_DIR, 'settings'));
+
+test('encodes version, speed as uint16 LE, theme, clock format and flags', () => {
+  assert.deepStrictEqual(settings.encode(settings.DEFAULTS), [1, 100, 0, 0, 0, 0]);
+  assert.deepStrictEqual(
+    settings.encode({ speed: 300, theme: 'ocean', clockFormat: '24h', fastStart: true }),
+    [1, 0x2C, 0x01, 2, 2, 0x01]);
+  assert.deepStrictEqual(settings.encode({ speed: 25, theme: 'ember', clockFormat: '12h' }),
+                         [1, 25, 0, 1, 1, 0]);
+});
+
+test('clamps and defaults what it encodes', () => {
+  assert.deepStrictEqual(settings.encode({ speed: 1000 }), [1, 0x90, 0x01, 0, 0, 0]);
+  assert.deepStrictEqual(settings.encode({ speed: -5 }), [1, 25, 0, 0, 0, 0]);
+  assert.deepStrictEqual(settings.encode({ speed: 'fast' }), [1, 100, 0, 0, 0, 0]);
+  assert.deepStrictEqual(settings.encode({ speed: '150.4' }), [1, 150, 0, 0, 0, 0]);
+  assert.deepStrictEqual(settings.encode({ theme: 'pink', clockFormat: 'metric' }),
+                         [1, 100, 0, 0, 0, 0]);
+  assert.deepStrictEqual(settings.encode(null), [1, 100, 0, 0, 0, 0]);
+  assert.deepStrictEqual(settings.encode({ fastStart: 'yes' })[5], 0x01);
+});
+
+test('decodes what it encodes and rejects malformed or older bytes', () => {
+  const values = { speed: 250, theme: 'ember', clockFormat: '24h', fastStart: true };
+  assert.deepStrictEqual(settings.decode(settings.encode(values)), values);
+  assert.deepStrictEqual(settings.decode([1, 0xFF, 0xFF, 7, 9, 0xFE]),
+                         { speed: 400, theme: 'mono', clockFormat: 'system', fastStart: false });
+  assert.strictEqual(settings.decode([0, 100, 0, 0, 0, 0]), null);
+  assert.strictEqual(settings.decode([1, 100, 0, 0, 0]), null);
+  assert.strictEqual(settings.decode(null), null);
+});
+
+test('reads the fields it knows from a newer version', () => {
+  assert.deepStrictEqual(settings.decode([2, 200, 0, 2, 1, 0x03, 7, 7]),
+                         { speed: 200, theme: 'ocean', clockFormat: '12h', fastStart: true });
+});
+
+test('stores sanitized settings and survives a corrupt store', () => {
+  const storage = createStorage();
+  assert.strictEqual(settings.load(storage), null);
+  settings.save(storage, { speed: 9999, theme: 'ocean', extra: 1 });
+  assert.deepStrictEqual(JSON.parse(storage.items['roundy-settings']),
+                         { speed: 400, theme: 'ocean', clockFormat: 'system', fastStart: false });
+  storage.setItem('roundy-settings', '{not json');
+  assert.strictEqual(settings.load(storage), null);
+});
+
+test('sends one Settings byte array and reports the outcome', () => {
+  const pebble = createPebble(null);
+  let result;
+  settings.send(pebble, { speed: 200 }, (error) => {
+    result = error;
+  });
+  assert.deepStrictEqual(pebble.sent, [{ Settings: [1, 200, 0, 0, 0, 0] }]);
+  assert.strictEqual(result, null);
+
+  settings.send(createPebble({ error: { message: 'busy' } }), {}, (error) => {
+    result = error;
+  });
+  assert.strictEqual(result, 'busy');
+  settings.send(createPebble({}), {}, (error) => {
+    result = error;
+  });
+  assert.strictEqual(result, 'send failed');
+});
+
+// index.js talks to the globals, so it is loaded fresh with them in place.
+function loadIndex(pebble, storage) {
+  global.Pebble = pebble;
+  global.localStorage = storage;
+  const index = path.join(PKJS_DIR, 'index.js');
+  delete require.cache[require.resolve(index)];
+  require(index);
+}
+
+test('the configuration page result is merged, stored and sent sanitized', () => {
+  const pebble = createPebble(null);
+  const storage = createStorage();
+  loadIndex(pebble, storage);
+
+  pebble.handlers.webviewclosed({
+    response: encodeURIComponent(JSON.stringify({ speed: 12, theme: 'ember' })),
+  });
+  pebble.handlers.webviewclosed({
+    response: encodeURIComponent(JSON.stringify({ clockFormat: '12h', fastStart: 1 })),
+  });
+  assert.deepStrictEqual(pebble.sent, [
+    { Settings: [1, 25, 0, 1, 0, 0] },
+    { Settings: [1, 25, 0, 1, 1, 0x01] },
+  ]);
+
+  // malformed or cancelled pages send nothing
+  pebble.handlers.webviewclosed({ response: '%7Bnot%20json' });
+  pebble.handlers.webviewclosed({});
+  assert.strictEqual(pebble.sent.length, 2);
+
+  // a restarted phone app catches the watch up from the stored copy
+  const restarted = createPebble(null);
+  loadIndex(restarted, storage);
+  restarted.handlers.ready();
+  assert.deepStrictEqual(restarted.sent, [{ Settings: [1, 25, 0, 1, 1, 0x01] }]);
+});
+
+test('nothing is sent on start-up before the settings were ever changed', () => {
+  const pebble = createPebble(null);
+  loadIndex(pebble, createStorage());
+  pebble.handlers.ready();
+  assert.deepStrictEqual(pebble.sent, []);
+});
+
+// index.js logs every step; keep the output to the results
+const log = console.log;
+let failures = 0;
+tests.forEach(({ name, run }) => {
+  console.log = () => {};
+  try {
+    run();
+    console.log = log;
+    console.log(`ok    ${name}`);
+  } catch (error) {
+    console.log = log;
+    console.log(`FAIL  ${name}\n${error.stack}`);
+    failures++;
+  }
+});
+console.log(`${tests.length} tests, ${failures} failed`);
+process.exit(failures ? 1 : 0);
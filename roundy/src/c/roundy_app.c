@@ -1,39 +1,132 @@
 #include <pebble.h>
 
 #include "roundy_background_layer.h"
+#include "roundy_compositor_layer.h"
 #include "roundy_digit_layer.h"
+#include "roundy_frame_dump.h"
+#include "roundy_frame_governor.h"
 #include "roundy_palette.h"
+#include "roundy_power.h"
+#include "roundy_profile.h"
+#include "roundy_render_stats.h"
+#include "roundy_replay.h"
+#include "roundy_settings.h"
+#include "roundy_trace.h"
 
 static Window *s_main_window;
 static RoundyBackgroundLayer *s_background_layer;
 static RoundyDigitLayer *s_digit_layer;
+static RoundyCompositorLayer *s_compositor_layer;
+#if defined(ROUNDY_FRAME_DUMP)
+static Layer *s_frame_dump_layer;
+#endif
 
 static void prv_tick_handler(struct tm *tick_time, TimeUnits units_changed) {
   (void)units_changed;
+  /* log what happened since the previous tick before this one adds to it */
+  roundy_trace_dump();
+  roundy_trace(RoundyTraceEventTick, 0);
+  roundy_power_minute(tick_time);
   roundy_digit_layer_set_time(s_digit_layer, tick_time);
+  roundy_render_stats_minute();
+}
+
+static void prv_power_mode_changed(RoundyPowerMode mode) {
+  roundy_frame_governor_set_min_interval(
+      (mode == RoundyPowerModeReduced) ? ROUNDY_POWER_REDUCED_FRAME_MS : 0);
+  roundy_digit_layer_set_instant(s_digit_layer, mode == RoundyPowerModeStatic);
+}
+
+/* Invalidates only what a changed setting affects. */
+static void prv_settings_changed(const RoundySettings *settings, uint32_t changed) {
+  if (changed & RoundySettingsChangedSpeed) {
+    roundy_digit_layer_set_speed(s_digit_layer, settings->speed_percent);
+  }
+  if (changed & RoundySettingsChangedTheme) {
+    roundy_palette_set_theme((RoundyPaletteTheme)settings->theme);
+    roundy_digit_layer_refresh_palette(s_digit_layer);
+  }
+  if (changed & RoundySettingsChangedClockFormat) {
+    roundy_digit_layer_set_clock_format(s_digit_layer,
+                                        (RoundyClockFormat)settings->clock_format);
+    roundy_digit_layer_refresh_time(s_digit_layer);
+  }
+  /* fast start only matters at the next launch */
 }
 
 static void prv_window_load(Window *window) {
   Layer *root = window_get_root_layer(window);
   const GRect bounds = layer_get_bounds(root);
+  const RoundySettings *settings = roundy_settings_get();
 
-  s_background_layer = roundy_background_layer_create(bounds);
-  if (s_background_layer) {
-    layer_add_child(root, roundy_background_layer_get_layer(s_background_layer));
+  /* before the layer paints its cell sprites */
+  roundy_palette_set_theme((RoundyPaletteTheme)settings->theme);
+  s_digit_layer = roundy_digit_layer_create(bounds);
+  roundy_digit_layer_set_speed(s_digit_layer, settings->speed_percent);
+  roundy_digit_layer_set_clock_format(s_digit_layer, (RoundyClockFormat)settings->clock_format);
+#if defined(ROUNDY_COMPOSITOR)
+  /* draw background and digits in one pass instead of two stacked layers */
+  s_compositor_layer = roundy_compositor_layer_create(bounds, s_digit_layer);
+  if (s_compositor_layer) {
+    layer_add_child(root, roundy_compositor_layer_get_layer(s_compositor_layer));
+  }
+#endif
+
+  if (!s_compositor_layer) {
+    s_background_layer = roundy_background_layer_create(bounds);
+    if (s_background_layer) {
+      layer_add_child(root, roundy_background_layer_get_layer(s_background_layer));
+    }
   }
 
-  s_digit_layer = roundy_digit_layer_create(bounds);
   if (s_digit_layer) {
     layer_add_child(root, roundy_digit_layer_get_layer(s_digit_layer));
+#if defined(ROUNDY_FRAME_DUMP)
+    /* on top, so it sees each frame after everything else has drawn */
+    if (!s_frame_dump_layer) {
+      s_frame_dump_layer = roundy_frame_dump_layer_create(bounds);
+    }
+    if (s_frame_dump_layer) {
+      layer_add_child(root, s_frame_dump_layer);
+    }
+#endif
+#if defined(ROUNDY_REPLAY)
+    roundy_replay_start(s_digit_layer);
+#else
+    /* show the digits of the last session settled in the first frame; only
+     * those that changed since then flip, which makes for a shorter intro */
+    if (settings->fast_start && roundy_digit_layer_restore_snapshot(s_digit_layer)) {
+      roundy_digit_layer_refresh_time(s_digit_layer);
+      if (!roundy_digit_layer_is_animating(s_digit_layer)) {
+        roundy_profile_settled();
+      }
+      return;
+    }
     roundy_digit_layer_refresh_time(s_digit_layer);
     /* start a quick diagonal flip animation when the watchface appears */
     roundy_digit_layer_start_diag_flip(s_digit_layer);
+#endif
   }
 }
 
 static void prv_window_unload(Window *window) {
   (void)window;
 
+#if defined(ROUNDY_FRAME_DUMP) && defined(ROUNDY_STATIC_ALLOC)
+  /* kept for the next load, like the Layers of the other layers */
+  layer_remove_from_parent(s_frame_dump_layer);
+#elif defined(ROUNDY_FRAME_DUMP)
+  layer_destroy(s_frame_dump_layer);
+  s_frame_dump_layer = NULL;
+#endif
+  roundy_compositor_layer_destroy(s_compositor_layer);
+  s_compositor_layer = NULL;
+
+#if !defined(ROUNDY_REPLAY)
+  if (roundy_settings_get()->fast_start) {
+    roundy_digit_layer_save_snapshot(s_digit_layer);
+  }
+#endif
   roundy_digit_layer_destroy(s_digit_layer);
   s_digit_layer = NULL;
 
@@ -41,20 +134,59 @@ static void prv_window_unload(Window *window) {
   s_background_layer = NULL;
 }
 
+#if defined(ROUNDY_PROFILE)
+/* Logs the heap after the window has loaded, along with how much layer state
+ * lives outside it; compare a ROUNDY_STATIC_ALLOC=1 build against a default
+ * one, both with ROUNDY_PROFILE=1, to see what static storage saves on each
+ * platform. */
+static void prv_log_memory(void) {
+  size_t layer_bytes = roundy_digit_layer_storage_size();
+  layer_bytes += s_compositor_layer ? roundy_compositor_layer_storage_size()
+                                    : roundy_background_layer_storage_size();
+#if defined(ROUNDY_STATIC_ALLOC)
+  const char *storage = "in static storage";
+#else
+  const char *storage = "on the heap";
+#endif
+  APP_LOG(APP_LOG_LEVEL_INFO, "memory: %d bytes heap used, %d free, %d bytes of layer state %s",
+          (int)heap_bytes_used(), (int)heap_bytes_free(), (int)layer_bytes, storage);
+}
+#endif
+
 static void prv_init(void) {
+  roundy_profile_startup();
   s_main_window = window_create();
   window_set_background_color(s_main_window, roundy_palette_window_background());
   window_set_window_handlers(s_main_window, (WindowHandlers){
                                             .load = prv_window_load,
                                             .unload = prv_window_unload,
                                           });
+#if !defined(ROUNDY_REPLAY)
+  /* the replay runs on the defaults so its numbers stay comparable */
+  roundy_settings_init(prv_settings_changed);
+#endif
 
   window_stack_push(s_main_window, true);
+#if defined(ROUNDY_PROFILE)
+  prv_log_memory();
+#endif
+  roundy_render_stats_init();
+  /* the inbox only ever holds the settings, the outbox the histograms */
+  app_message_open(APP_MESSAGE_INBOX_SIZE_MINIMUM,
+                   dict_calc_buffer_size(1, ROUNDY_RENDER_STATS_MESSAGE_SIZE));
+#if !defined(ROUNDY_REPLAY)
+  /* the replay measures full animations, so it leaves the policy out */
+  roundy_power_init(prv_power_mode_changed);
   tick_timer_service_subscribe(MINUTE_UNIT, prv_tick_handler);
+#endif
 }
 
 static void prv_deinit(void) {
+  roundy_trace_dump();
   tick_timer_service_unsubscribe();
+#if !defined(ROUNDY_REPLAY)
+  roundy_power_deinit();
+#endif
   window_destroy(s_main_window);
   s_main_window = NULL;
 }
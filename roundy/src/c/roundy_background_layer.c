@@ -2,13 +2,84 @@
 
 #include <stdlib.h>
 
+#include "roundy_bitmap.h"
+#include "roundy_frame_governor.h"
 #include "roundy_layout.h"
 #include "roundy_palette.h"
+#include "roundy_profile.h"
+#include "roundy_render_stats.h"
+#include "roundy_trace.h"
+
+/* The grid repeats every ROUNDY_CELL_SIZE rows, so the whole background is
+ * described by one template row per pixel row inside a cell plus one plain
+ * fill row for the area below the grid. */
+#define TEMPLATE_FILL_ROW ROUNDY_CELL_SIZE
+#define TEMPLATE_ROW_COUNT (ROUNDY_CELL_SIZE + 1)
 
 struct RoundyBackgroundLayer {
   Layer *layer;
+  RoundyBackgroundMode mode;
+  /* row templates and pre-rendered grid, rebuilt only when the bounds or
+   * palette change */
+  GBitmap *templates;
+  GBitmap *cache;
+  GRect cache_bounds;
+  GColor cache_fill;
+  GColor cache_stroke;
 };
 
+#if defined(ROUNDY_STATIC_ALLOC)
+/* The only background layer. Its Layer, and the GBitmaps over the static
+ * pixels below, are created once and kept across destroy() and create(). */
+static RoundyBackgroundLayer s_background_layer;
+static bool s_background_layer_in_use;
+static GBitmap *s_templates;
+static GBitmap *s_cache;
+static uint8_t s_template_pixels[ROUNDY_BITMAP_NATIVE_BYTES(PBL_DISPLAY_WIDTH, TEMPLATE_ROW_COUNT)];
+static uint8_t s_cache_pixels[ROUNDY_BITMAP_NATIVE_BYTES(PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT)];
+
+/* Narrows `*bitmap`, created on first use over `pixels` at `capacity`, to
+ * `size`; NULL if that does not fit. */
+static GBitmap *prv_static_bitmap(GBitmap **bitmap, uint8_t *pixels, size_t pixels_size,
+                                  GSize capacity, GSize size) {
+  if (size.w > capacity.w || size.h > capacity.h) {
+    return NULL;
+  }
+  if (!*bitmap) {
+    *bitmap = roundy_bitmap_create_native_with_data(capacity, pixels, pixels_size);
+    if (!*bitmap) {
+      return NULL;
+    }
+  }
+  gbitmap_set_bounds(*bitmap, GRect(0, 0, size.w, size.h));
+  return *bitmap;
+}
+#endif
+
+static GBitmap *prv_create_templates(GSize size) {
+#if defined(ROUNDY_STATIC_ALLOC)
+  return prv_static_bitmap(&s_templates, s_template_pixels, sizeof(s_template_pixels),
+                           GSize(PBL_DISPLAY_WIDTH, TEMPLATE_ROW_COUNT), size);
+#else
+  return roundy_bitmap_create_native(size);
+#endif
+}
+
+static GBitmap *prv_create_cache(GSize size) {
+#if defined(ROUNDY_STATIC_ALLOC)
+  return prv_static_bitmap(&s_cache, s_cache_pixels, sizeof(s_cache_pixels),
+                           GSize(PBL_DISPLAY_WIDTH, PBL_DISPLAY_HEIGHT), size);
+#else
+  return roundy_bitmap_create_native(size);
+#endif
+}
+
+static void prv_destroy_bitmap(GBitmap *bitmap) {
+#if !defined(ROUNDY_STATIC_ALLOC)
+  gbitmap_destroy(bitmap);
+#endif
+}
+
 static void prv_draw_background_cell(GContext *ctx, int cell_col, int cell_row) {
   const GPoint origin = roundy_cell_origin(cell_col, cell_row);
 
@@ -17,32 +88,224 @@ static void prv_draw_background_cell(GContext *ctx, int cell_col, int cell_row)
   }
 }
 
-static void prv_background_update_proc(Layer *layer, GContext *ctx) {
-  const GRect bounds = layer_get_bounds(layer);
-
+static void prv_draw_background(GContext *ctx, GRect bounds) {
   graphics_context_set_fill_color(ctx, roundy_palette_background_fill());
   graphics_fill_rect(ctx, bounds, 0, GCornerNone);
 
   graphics_context_set_stroke_color(ctx, roundy_palette_background_stroke());
+  int cells = 0;
   for (int row = 0; row < ROUNDY_GRID_ROWS; ++row) {
-    for (int col = 0; col < ROUNDY_GRID_COLS; ++col) {
+    const RoundyCellSpan span = roundy_layout_row_span(row);
+    for (int col = span.first_col; col < span.end_col; ++col) {
       prv_draw_background_cell(ctx, col, row);
     }
+    cells += span.end_col - span.first_col;
   }
+  roundy_profile_count(RoundyProfileSectionBackground, 1 + cells * ROUNDY_CELL_SIZE,
+                       bounds.size.w * bounds.size.h + cells * ROUNDY_CELL_SIZE);
 }
 
-RoundyBackgroundLayer *roundy_background_layer_create(GRect frame) {
+static inline int prv_template_row(int y) {
+  return (y < ROUNDY_GRID_ROWS * ROUNDY_CELL_SIZE) ? (y % ROUNDY_CELL_SIZE)
+                                                   : TEMPLATE_FILL_ROW;
+}
+
+static bool prv_templates_are_valid(const RoundyBackgroundLayer *layer, GRect bounds) {
+  return layer->templates && grect_equal(&layer->cache_bounds, &bounds) &&
+         gcolor_equal(layer->cache_fill, roundy_palette_background_fill()) &&
+         gcolor_equal(layer->cache_stroke, roundy_palette_background_stroke());
+}
+
+static void prv_release_caches(RoundyBackgroundLayer *layer) {
+  if (layer->templates) {
+    prv_destroy_bitmap(layer->templates);
+    layer->templates = NULL;
+  }
+  if (layer->cache) {
+    prv_destroy_bitmap(layer->cache);
+    layer->cache = NULL;
+  }
+}
+
+static bool prv_rebuild_templates(RoundyBackgroundLayer *layer, GRect bounds) {
+  prv_release_caches(layer);
+
+  layer->templates = prv_create_templates(GSize(bounds.size.w, TEMPLATE_ROW_COUNT));
+  if (!layer->templates) {
+    return false;
+  }
+
+  const GColor fill = roundy_palette_background_fill();
+  const GColor stroke = roundy_palette_background_stroke();
+  roundy_bitmap_fill(layer->templates, fill);
+  for (int x = 0; x < bounds.size.w && x < ROUNDY_GRID_COLS * ROUNDY_CELL_SIZE; ++x) {
+    roundy_bitmap_set_pixel(layer->templates, x, x % ROUNDY_CELL_SIZE, stroke);
+  }
+
+  layer->cache_bounds = bounds;
+  layer->cache_fill = fill;
+  layer->cache_stroke = stroke;
+  return true;
+}
+
+static bool prv_rebuild_cache(RoundyBackgroundLayer *layer, GRect bounds) {
+  layer->cache = prv_create_cache(bounds.size);
+  if (!layer->cache) {
+    return false;
+  }
+
+  const uint8_t *templates = gbitmap_get_data(layer->templates);
+  const uint16_t template_stride = gbitmap_get_bytes_per_row(layer->templates);
+  uint8_t *data = gbitmap_get_data(layer->cache);
+  const uint16_t stride = gbitmap_get_bytes_per_row(layer->cache);
+  for (int y = 0; y < bounds.size.h; ++y) {
+    memcpy(data + (y * stride), templates + (prv_template_row(y) * template_stride),
+           (stride < template_stride) ? stride : template_stride);
+  }
+  return true;
+}
+
+/* Copies the template rows straight into the framebuffer. Only possible when
+ * the layer covers the whole framebuffer, otherwise returns false. */
+static bool prv_draw_direct(RoundyBackgroundLayer *background, GContext *ctx,
+                            GRect bounds) {
+  const GRect frame = layer_get_frame(background->layer);
+  if (frame.origin.x != 0 || frame.origin.y != 0) {
+    return false;
+  }
+
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) {
+    return false;
+  }
+
+  const GRect fb_bounds = gbitmap_get_bounds(fb);
+  const GBitmapFormat expected_format =
+      PBL_IF_ROUND_ELSE(GBitmapFormat8BitCircular,
+                        PBL_IF_COLOR_ELSE(GBitmapFormat8Bit, GBitmapFormat1Bit));
+  if (gbitmap_get_format(fb) != expected_format ||
+      fb_bounds.size.w != bounds.size.w || fb_bounds.size.h != bounds.size.h) {
+    graphics_release_frame_buffer(ctx, fb);
+    return false;
+  }
+
+  const uint8_t *templates = gbitmap_get_data(background->templates);
+  const uint16_t template_stride = gbitmap_get_bytes_per_row(background->templates);
+#if defined(PBL_ROUND)
+  /* chalk rows only hold the visible span of the circular display */
+  for (int y = 0; y < bounds.size.h; ++y) {
+    const GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, y);
+    const uint8_t *src = templates + (prv_template_row(y) * template_stride);
+    memcpy(info.data + info.min_x, src + info.min_x, info.max_x - info.min_x + 1);
+  }
+#else
+  /* 8-bit rows hold one GColor8 per pixel, 1-bit rows are packed LSB first;
+   * either way a template row is a verbatim copy of a framebuffer row */
+  uint8_t *data = gbitmap_get_data(fb);
+  const uint16_t stride = gbitmap_get_bytes_per_row(fb);
+  const uint16_t row_bytes = (stride < template_stride) ? stride : template_stride;
+  for (int y = 0; y < bounds.size.h; ++y) {
+    memcpy(data + (y * stride), templates + (prv_template_row(y) * template_stride),
+           row_bytes);
+  }
+#endif
+  graphics_release_frame_buffer(ctx, fb);
+
+  roundy_profile_count(RoundyProfileSectionBackground, 0,
+                       bounds.size.w * bounds.size.h);
+  return true;
+}
+
+static void prv_draw(RoundyBackgroundLayer *background, GContext *ctx, GRect bounds) {
+  roundy_profile_frame_begin(RoundyProfileSectionBackground);
+  if (!prv_templates_are_valid(background, bounds) &&
+      !prv_rebuild_templates(background, bounds)) {
+    /* not enough heap for the templates, draw the grid directly */
+    prv_draw_background(ctx, bounds);
+    roundy_profile_frame_end(RoundyProfileSectionBackground);
+    return;
+  }
+
+  if (background->mode == RoundyBackgroundModeDirect &&
+      prv_draw_direct(background, ctx, bounds)) {
+    roundy_profile_frame_end(RoundyProfileSectionBackground);
+    return;
+  }
+
+  if (background->cache || prv_rebuild_cache(background, bounds)) {
+    graphics_context_set_compositing_mode(ctx, GCompOpAssign);
+    graphics_draw_bitmap_in_rect(ctx, background->cache, bounds);
+    roundy_profile_count(RoundyProfileSectionBackground, 1,
+                         bounds.size.w * bounds.size.h);
+  } else {
+    prv_draw_background(ctx, bounds);
+  }
+  roundy_profile_frame_end(RoundyProfileSectionBackground);
+}
+
+static void prv_background_update_proc(Layer *layer, GContext *ctx) {
+  RoundyBackgroundLayer *background = *(RoundyBackgroundLayer **)layer_get_data(layer);
+
+  roundy_trace(RoundyTraceEventUpdateBegin, RoundyTraceLayerBackground);
+  const uint32_t start_ms = roundy_render_stats_begin();
+  roundy_frame_governor_render_begin();
+  prv_draw(background, ctx, layer_get_bounds(layer));
+  roundy_frame_governor_render_end();
+  roundy_render_stats_end(RoundyProfileSectionBackground, start_ms);
+  roundy_trace(RoundyTraceEventUpdateEnd, RoundyTraceLayerBackground);
+}
+
+/* Allocates the wrapper, zeroed, and its Layer. */
+static RoundyBackgroundLayer *prv_alloc(GRect frame) {
+#if defined(ROUNDY_STATIC_ALLOC)
+  if (s_background_layer_in_use) {
+    return NULL;
+  }
+
+  RoundyBackgroundLayer *layer = &s_background_layer;
+  *layer = (RoundyBackgroundLayer){.layer = layer->layer};
+  if (layer->layer) {
+    layer_set_frame(layer->layer, frame);
+  } else {
+    layer->layer = layer_create_with_data(frame, sizeof(RoundyBackgroundLayer *));
+    if (!layer->layer) {
+      return NULL;
+    }
+  }
+  s_background_layer_in_use = true;
+#else
   RoundyBackgroundLayer *layer = calloc(1, sizeof(*layer));
   if (!layer) {
     return NULL;
   }
 
-  layer->layer = layer_create(frame);
+  layer->layer = layer_create_with_data(frame, sizeof(RoundyBackgroundLayer *));
   if (!layer->layer) {
     free(layer);
     return NULL;
   }
+#endif
+  return layer;
+}
+
+/* Releases the wrapper and its Layer; the static ones are only detached. */
+static void prv_free(RoundyBackgroundLayer *layer) {
+#if defined(ROUNDY_STATIC_ALLOC)
+  layer_remove_from_parent(layer->layer);
+  s_background_layer_in_use = false;
+#else
+  layer_destroy(layer->layer);
+  free(layer);
+#endif
+}
+
+RoundyBackgroundLayer *roundy_background_layer_create(GRect frame) {
+  RoundyBackgroundLayer *layer = prv_alloc(frame);
+  if (!layer) {
+    return NULL;
+  }
 
+  *(RoundyBackgroundLayer **)layer_get_data(layer->layer) = layer;
   layer_set_update_proc(layer->layer, prv_background_update_proc);
   return layer;
 }
@@ -52,10 +315,12 @@ void roundy_background_layer_destroy(RoundyBackgroundLayer *layer) {
     return;
   }
 
-  if (layer->layer) {
-    layer_destroy(layer->layer);
-  }
-  free(layer);
+  prv_release_caches(layer);
+  prv_free(layer);
+}
+
+size_t roundy_background_layer_storage_size(void) {
+  return sizeof(RoundyBackgroundLayer);
 }
 
 Layer *roundy_background_layer_get_layer(RoundyBackgroundLayer *layer) {
@@ -64,6 +329,21 @@ Layer *roundy_background_layer_get_layer(RoundyBackgroundLayer *layer) {
 
 void roundy_background_layer_mark_dirty(RoundyBackgroundLayer *layer) {
   if (layer && layer->layer) {
+    roundy_trace(RoundyTraceEventMarkDirty, RoundyTraceLayerBackground);
     layer_mark_dirty(layer->layer);
   }
 }
+
+void roundy_background_layer_set_mode(RoundyBackgroundLayer *layer, RoundyBackgroundMode mode) {
+  if (!layer || layer->mode == mode) {
+    return;
+  }
+
+  layer->mode = mode;
+  if (mode == RoundyBackgroundModeDirect && layer->cache) {
+    /* the full-size bitmap is only needed by the cached mode */
+    prv_destroy_bitmap(layer->cache);
+    layer->cache = NULL;
+  }
+  roundy_background_layer_mark_dirty(layer);
+}
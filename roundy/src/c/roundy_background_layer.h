@@ -4,7 +4,17 @@
 
 typedef struct RoundyBackgroundLayer RoundyBackgroundLayer;
 
+typedef enum {
+  /* write precomputed row templates straight into the captured framebuffer */
+  RoundyBackgroundModeDirect = 0,
+  /* blit a pre-rendered full-size bitmap of the grid */
+  RoundyBackgroundModeCached,
+} RoundyBackgroundMode;
+
 RoundyBackgroundLayer *roundy_background_layer_create(GRect frame);
 void roundy_background_layer_destroy(RoundyBackgroundLayer *layer);
 Layer *roundy_background_layer_get_layer(RoundyBackgroundLayer *layer);
+/* Bytes behind one background layer, see roundy_digit_layer_storage_size(). */
+size_t roundy_background_layer_storage_size(void);
 void roundy_background_layer_mark_dirty(RoundyBackgroundLayer *layer);
+void roundy_background_layer_set_mode(RoundyBackgroundLayer *layer, RoundyBackgroundMode mode);
@@ -0,0 +1,70 @@
+#include "roundy_bitmap.h"
+
+#define NATIVE_FORMAT PBL_IF_COLOR_ELSE(GBitmapFormat8Bit, GBitmapFormat1Bit)
+/* .pbi info flags: version 1 in the top four bits, the format from bit 1 */
+#define HEADER_FLAGS ((1 << 12) | (NATIVE_FORMAT << 1))
+
+GBitmap *roundy_bitmap_create_native(GSize size) {
+  return gbitmap_create_blank(size, NATIVE_FORMAT);
+}
+
+static inline void prv_put_u16(uint8_t *data, uint16_t value) {
+  data[0] = (uint8_t)(value & 0xFF);
+  data[1] = (uint8_t)(value >> 8);
+}
+
+GBitmap *roundy_bitmap_create_native_with_data(GSize size, uint8_t *buffer,
+                                               size_t buffer_size) {
+  if (!buffer || size.w <= 0 || size.h <= 0 ||
+      buffer_size < (size_t)ROUNDY_BITMAP_NATIVE_BYTES(size.w, size.h)) {
+    return NULL;
+  }
+
+  /* row size, flags, then the bounds as x, y, w, h */
+  prv_put_u16(buffer, ROUNDY_BITMAP_NATIVE_STRIDE(size.w));
+  prv_put_u16(buffer + 2, HEADER_FLAGS);
+  prv_put_u16(buffer + 4, 0);
+  prv_put_u16(buffer + 6, 0);
+  prv_put_u16(buffer + 8, (uint16_t)size.w);
+  prv_put_u16(buffer + 10, (uint16_t)size.h);
+  return gbitmap_create_with_data(buffer);
+}
+
+void roundy_bitmap_fill(GBitmap *bitmap, GColor color) {
+  if (!bitmap) {
+    return;
+  }
+
+  const GRect bounds = gbitmap_get_bounds(bitmap);
+  const uint16_t bytes_per_row = gbitmap_get_bytes_per_row(bitmap);
+#if defined(PBL_COLOR)
+  const uint8_t value = color.argb;
+#else
+  const uint8_t value = gcolor_equal(color, GColorWhite) ? 0xFF : 0x00;
+#endif
+  memset(gbitmap_get_data(bitmap), value, bytes_per_row * bounds.size.h);
+}
+
+void roundy_bitmap_set_pixel(GBitmap *bitmap, int x, int y, GColor color) {
+  if (!bitmap) {
+    return;
+  }
+
+  const GRect bounds = gbitmap_get_bounds(bitmap);
+  if (x < 0 || y < 0 || x >= bounds.size.w || y >= bounds.size.h) {
+    return;
+  }
+
+  uint8_t *row = gbitmap_get_data(bitmap) + (y * gbitmap_get_bytes_per_row(bitmap));
+#if defined(PBL_COLOR)
+  row[x] = color.argb;
+#else
+  /* 1-bit rows are packed LSB first, a set bit is a white pixel */
+  const uint8_t bit = (uint8_t)(1 << (x % 8));
+  if (gcolor_equal(color, GColorWhite)) {
+    row[x / 8] |= bit;
+  } else {
+    row[x / 8] &= (uint8_t)~bit;
+  }
+#endif
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <pebble.h>
+
+/* Helpers for off-screen bitmaps in the platform's native framebuffer format
+ * (1-bit on black & white displays, 8-bit GColor8 elsewhere). */
+
+GBitmap *roundy_bitmap_create_native(GSize size);
+
+/* Bytes in front of the pixels of a buffer for
+ * roundy_bitmap_create_native_with_data(): the header of a .pbi image, which
+ * gbitmap_create_with_data() reads the size and format from. */
+#define ROUNDY_BITMAP_HEADER_SIZE 12
+/* Bytes per row of a native bitmap `w` pixels wide; 1-bit rows are padded to
+ * whole words, as gbitmap_create_blank() does. */
+#define ROUNDY_BITMAP_NATIVE_STRIDE(w) PBL_IF_COLOR_ELSE((w), (((w) + 31) / 32) * 4)
+/* Size of a buffer for a native `w` x `h` bitmap, header included. */
+#define ROUNDY_BITMAP_NATIVE_BYTES(w, h) \
+  (ROUNDY_BITMAP_HEADER_SIZE + (ROUNDY_BITMAP_NATIVE_STRIDE(w) * (h)))
+
+/* Like roundy_bitmap_create_native(), but the pixels live in `buffer`, which
+ * must hold `buffer_size` >= ROUNDY_BITMAP_NATIVE_BYTES(size.w, size.h) bytes
+ * and outlive the bitmap; only the GBitmap itself comes from the heap. The
+ * pixels are not cleared. Returns NULL if `size` does not fit. */
+GBitmap *roundy_bitmap_create_native_with_data(GSize size, uint8_t *buffer,
+                                               size_t buffer_size);
+void roundy_bitmap_fill(GBitmap *bitmap, GColor color);
+void roundy_bitmap_set_pixel(GBitmap *bitmap, int x, int y, GColor color);
@@ -0,0 +1,186 @@
+#include "roundy_cell_atlas.h"
+
+#include <stdlib.h>
+
+#include "roundy_bitmap.h"
+#include "roundy_dither.h"
+#include "roundy_layout.h"
+
+/* 6 px cells have 9 distinct steps; larger cells may need more than the
+ * retained cell state of the digit layer can encode */
+_Static_assert(ROUNDY_CELL_SIZE <= 6, "cell steps must fit ROUNDY_CELL_MAX_STEPS");
+
+struct RoundyCellAtlas {
+  GBitmap *bitmap;
+};
+
+/* sorted progress values at which the diagonal pattern changes; step n covers
+ * [s_thresholds[n - 1], s_thresholds[n]) */
+static RoundyProgress s_thresholds[ROUNDY_CELL_MAX_STEPS - 1];
+static uint8_t s_threshold_count;
+static bool s_thresholds_ready;
+
+static void prv_add_threshold(RoundyProgress threshold) {
+  if ((size_t)s_threshold_count >= ARRAY_LENGTH(s_thresholds)) {
+    return;
+  }
+
+  int pos = s_threshold_count;
+  for (int i = 0; i < s_threshold_count; ++i) {
+    if (s_thresholds[i] == threshold) {
+      return;
+    }
+    if (s_thresholds[i] > threshold) {
+      pos = i;
+      break;
+    }
+  }
+  memmove(&s_thresholds[pos + 1], &s_thresholds[pos],
+          (s_threshold_count - pos) * sizeof(s_thresholds[0]));
+  s_thresholds[pos] = threshold;
+  s_threshold_count++;
+}
+
+/* Collects the smallest progress values at which roundy_progress_diag_offset
+ * changes for some row. Row `idx` moves from idx to CELL_SIZE - 1 - idx, one
+ * pixel at each half-way crossing; offsets round half up, so rows moving right
+ * switch at the crossing and rows moving left just after it. */
+static void prv_compute_thresholds(void) {
+  if (s_thresholds_ready) {
+    return;
+  }
+
+  s_threshold_count = 0;
+  for (int idx = 0; idx < ROUNDY_CELL_SIZE; ++idx) {
+    const int slope = ROUNDY_CELL_SIZE - 1 - (2 * idx);
+    const int distance = (slope < 0) ? -slope : slope;
+    for (int j = 0; j < distance; ++j) {
+      const RoundyProgress crossing = (j * ROUNDY_PROGRESS_ONE) + ROUNDY_PROGRESS_HALF;
+      const RoundyProgress threshold = (slope > 0)
+                                           ? (crossing + distance - 1) / distance
+                                           : (crossing / distance) + 1;
+      prv_add_threshold(threshold);
+    }
+  }
+  s_thresholds_ready = true;
+}
+
+int roundy_cell_step(RoundyProgress progress) {
+  prv_compute_thresholds();
+  int step = 0;
+  while (step < s_threshold_count && progress >= s_thresholds[step]) {
+    ++step;
+  }
+  return step;
+}
+
+RoundyProgress roundy_cell_step_progress(int step) {
+  prv_compute_thresholds();
+  return (step == 0) ? 0 : s_thresholds[step - 1];
+}
+
+int roundy_cell_step_count(void) {
+  prv_compute_thresholds();
+  return s_threshold_count + 1;
+}
+
+static GSize prv_atlas_size(void) {
+  return GSize(roundy_cell_step_count() * ROUNDY_CELL_SIZE,
+               RoundyCellColorCount * ROUNDY_CELL_SIZE);
+}
+
+#if defined(ROUNDY_STATIC_ALLOC)
+/* The only atlas. Its GBitmap is created once, over the static pixels, and
+ * kept across destroy() and create(). */
+static RoundyCellAtlas s_atlas;
+static bool s_atlas_in_use;
+static uint8_t s_atlas_pixels[ROUNDY_BITMAP_NATIVE_BYTES(ROUNDY_CELL_MAX_STEPS * ROUNDY_CELL_SIZE,
+                                                         RoundyCellColorCount * ROUNDY_CELL_SIZE)];
+
+RoundyCellAtlas *roundy_cell_atlas_create(void) {
+  if (s_atlas_in_use) {
+    return NULL;
+  }
+
+  if (!s_atlas.bitmap) {
+    s_atlas.bitmap = roundy_bitmap_create_native_with_data(prv_atlas_size(), s_atlas_pixels,
+                                                           sizeof(s_atlas_pixels));
+    if (!s_atlas.bitmap) {
+      return NULL;
+    }
+  }
+  s_atlas_in_use = true;
+  return &s_atlas;
+}
+#else
+RoundyCellAtlas *roundy_cell_atlas_create(void) {
+  RoundyCellAtlas *atlas = calloc(1, sizeof(*atlas));
+  if (!atlas) {
+    return NULL;
+  }
+
+  atlas->bitmap = roundy_bitmap_create_native(prv_atlas_size());
+  if (!atlas->bitmap) {
+    free(atlas);
+    return NULL;
+  }
+  return atlas;
+}
+#endif
+
+void roundy_cell_atlas_paint(RoundyCellAtlas *atlas, GColor fill, const GColor colors[],
+                             const uint8_t levels[], int color_count) {
+  if (!atlas) {
+    return;
+  }
+
+  const int step_count = roundy_cell_step_count();
+  /* drawing narrows the bounds to one sprite */
+  const GSize size = prv_atlas_size();
+  gbitmap_set_bounds(atlas->bitmap, GRect(0, 0, size.w, size.h));
+  roundy_bitmap_fill(atlas->bitmap, fill);
+  for (int color = 0; color < color_count && color < RoundyCellColorCount; ++color) {
+#if defined(PBL_BW)
+    (void)colors;
+    const GColor stroke = GColorWhite;
+    const uint8_t rows = roundy_dither_rows(levels[color]);
+#else
+    (void)levels;
+    const GColor stroke = colors[color];
+    const uint8_t rows = (1 << ROUNDY_CELL_SIZE) - 1;
+#endif
+    for (int step = 0; step < step_count; ++step) {
+      const RoundyProgress progress = roundy_cell_step_progress(step);
+      for (int idx = 0; idx < ROUNDY_CELL_SIZE; ++idx) {
+        if (rows & (1 << idx)) {
+          roundy_bitmap_set_pixel(atlas->bitmap,
+                                  (step * ROUNDY_CELL_SIZE) +
+                                      roundy_progress_diag_offset(progress, idx),
+                                  (color * ROUNDY_CELL_SIZE) + idx, stroke);
+        }
+      }
+    }
+  }
+}
+
+void roundy_cell_atlas_destroy(RoundyCellAtlas *atlas) {
+  if (!atlas) {
+    return;
+  }
+
+#if defined(ROUNDY_STATIC_ALLOC)
+  s_atlas_in_use = false;
+#else
+  if (atlas->bitmap) {
+    gbitmap_destroy(atlas->bitmap);
+  }
+  free(atlas);
+#endif
+}
+
+void roundy_cell_atlas_draw(RoundyCellAtlas *atlas, GContext *ctx, GRect frame, int step,
+                            RoundyCellColor color) {
+  gbitmap_set_bounds(atlas->bitmap, GRect(step * ROUNDY_CELL_SIZE, color * ROUNDY_CELL_SIZE,
+                                          ROUNDY_CELL_SIZE, ROUNDY_CELL_SIZE));
+  graphics_draw_bitmap_in_rect(ctx, atlas->bitmap, frame);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <pebble.h>
+
+#include "roundy_palette.h"
+#include "roundy_progress.h"
+
+/* Colour rows of the atlas: the settled stroke colour followed by one row per
+ * gradient step of the palette theme; themes with fewer steps leave the last
+ * rows unused. */
+typedef enum {
+  RoundyCellColorStroke = 0,
+  RoundyCellColorGradient,
+  RoundyCellColorCount = RoundyCellColorGradient + ROUNDY_PALETTE_MAX_STEPS
+} RoundyCellColor;
+
+/* Pre-rendered ROUNDY_CELL_SIZE sprites of a digit cell for every distinct
+ * diagonal position (step) and colour, drawn with a single blit each. */
+typedef struct RoundyCellAtlas RoundyCellAtlas;
+
+/* Upper bound on the number of distinct diagonal steps of a cell. */
+#define ROUNDY_CELL_MAX_STEPS 16
+
+/* Quantizes `progress` to the step whose diagonal matches the one drawn by
+ * roundy_progress_diag_offset() for that progress exactly. */
+int roundy_cell_step(RoundyProgress progress);
+/* Smallest progress that quantizes to `step`. */
+RoundyProgress roundy_cell_step_progress(int step);
+/* Number of distinct steps, at most ROUNDY_CELL_MAX_STEPS. */
+int roundy_cell_step_count(void);
+
+/* The atlas holds no sprites until painted. Built with ROUNDY_STATIC_ALLOC
+ * there is one atlas, with its pixels in static storage, and create() returns
+ * NULL while it is in use. */
+RoundyCellAtlas *roundy_cell_atlas_create(void);
+/* Redraws the sprites of the first `color_count` colour rows in place. On
+ * black and white displays the strokes are white, dithered by the grey
+ * `levels` of their rows (see roundy_dither.h), and `colors` is unused. */
+void roundy_cell_atlas_paint(RoundyCellAtlas *atlas, GColor fill, const GColor colors[],
+                             const uint8_t levels[], int color_count);
+void roundy_cell_atlas_destroy(RoundyCellAtlas *atlas);
+void roundy_cell_atlas_draw(RoundyCellAtlas *atlas, GContext *ctx, GRect frame, int step,
+                            RoundyCellColor color);
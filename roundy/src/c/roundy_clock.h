@@ -0,0 +1,29 @@
+#pragma once
+
+#include <pebble.h>
+
+/* Wall-clock milliseconds. Wraps after ~49 days, so only differences between
+ * two readings are meaningful. */
+static inline uint32_t roundy_clock_now_ms(void) {
+  time_t seconds;
+  uint16_t millis;
+  time_ms(&seconds, &millis);
+  return ((uint32_t)seconds * 1000) + millis;
+}
+
+/* Clock and timer of the animation timelines. They follow the wall clock,
+ * except in ROUNDY_REPLAY builds where roundy_replay.c runs them on a
+ * virtual clock that jumps straight to each timer's deadline. */
+#if defined(ROUNDY_REPLAY)
+
+uint32_t roundy_clock_timeline_ms(void);
+AppTimer *roundy_clock_timer_register(uint32_t delay_ms, AppTimerCallback callback,
+                                      void *data);
+
+#else
+
+#define roundy_clock_timeline_ms() roundy_clock_now_ms()
+#define roundy_clock_timer_register(delay_ms, callback, data) \
+  app_timer_register(delay_ms, callback, data)
+
+#endif
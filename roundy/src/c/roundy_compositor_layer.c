@@ -0,0 +1,351 @@
+#include "roundy_compositor_layer.h"
+
+#include <stdlib.h>
+
+#include "roundy_cell_atlas.h"
+#include "roundy_dither.h"
+#include "roundy_frame_governor.h"
+#include "roundy_layout.h"
+#include "roundy_palette.h"
+#include "roundy_profile.h"
+#include "roundy_render_stats.h"
+#include "roundy_trace.h"
+
+struct RoundyCompositorLayer {
+  Layer *layer;
+  RoundyDigitLayer *digits;
+  /* x offset of the diagonal pixel in every row of a cell, per step */
+  uint8_t offsets[ROUNDY_CELL_MAX_STEPS][ROUNDY_CELL_SIZE];
+};
+
+/* What one cell looks like: a fill colour with a single stroke pixel in each
+ * of the rows set in `rows`. */
+typedef struct {
+  GColor fill;
+  GColor stroke;
+  const uint8_t *offsets;
+  uint8_t rows;
+} RoundyCompositorCell;
+
+#define ALL_ROWS ((uint8_t)((1 << ROUNDY_CELL_SIZE) - 1))
+
+#if defined(ROUNDY_STATIC_ALLOC)
+/* the only compositor layer; its Layer is created once and kept across
+ * destroy() and create() */
+static RoundyCompositorLayer s_compositor_layer;
+static bool s_compositor_layer_in_use;
+#endif
+
+#if defined(PBL_COLOR)
+static inline void prv_put_pixel(uint8_t *row, int x, GColor color) {
+  row[x] = color.argb;
+}
+#endif
+
+static void prv_build_offsets(RoundyCompositorLayer *compositor) {
+  const int step_count = roundy_cell_step_count();
+  for (int step = 0; step < step_count; ++step) {
+    const RoundyProgress progress = roundy_cell_step_progress(step);
+    for (int idx = 0; idx < ROUNDY_CELL_SIZE; ++idx) {
+      compositor->offsets[step][idx] = (uint8_t)roundy_progress_diag_offset(progress, idx);
+    }
+  }
+}
+
+/* Resolves the visible cells of grid row `row` to their colours and
+ * diagonal. Returns the number of lit digit cells. */
+static int prv_resolve_row(RoundyCompositorLayer *compositor, int row,
+                           RoundyCompositorCell cells[ROUNDY_GRID_COLS]) {
+  RoundyDigitCell digit_cells[ROUNDY_GRID_COLS];
+  const int lit = roundy_digit_layer_get_cell_row(compositor->digits, row, digit_cells);
+  const RoundyCellSpan span = roundy_layout_row_span(row);
+  for (int col = span.first_col; col < span.end_col; ++col) {
+    if (digit_cells[col].lit) {
+      cells[col] = (RoundyCompositorCell){
+        .fill = roundy_palette_digit_fill(),
+#if defined(PBL_BW)
+        /* grey steps are dithered, see roundy_dither.h */
+        .stroke = GColorWhite,
+        .rows = roundy_dither_rows(digit_cells[col].level),
+#else
+        .stroke = digit_cells[col].stroke,
+        .rows = ALL_ROWS,
+#endif
+        .offsets = compositor->offsets[digit_cells[col].step],
+      };
+    } else {
+      /* the background diagonal is the unflipped '\' of step 0 */
+      cells[col] = (RoundyCompositorCell){
+        .fill = roundy_palette_background_fill(),
+        .stroke = roundy_palette_background_stroke(),
+        .offsets = compositor->offsets[0],
+        .rows = ALL_ROWS,
+      };
+    }
+  }
+  return lit;
+}
+
+#if defined(PBL_BW)
+
+static inline uint8_t prv_bits(GColor color) {
+  return gcolor_equal(color, GColorWhite) ? 0xFF : 0x00;
+}
+
+/* Writes one 1-bit framebuffer row, packed LSB first with a set bit for a
+ * white pixel, a whole byte at a time: the pixels of each cell are gathered
+ * into an accumulator that is flushed every 8 px. Black and white displays
+ * are rectangular, so the row starts at x = 0 and every grid cell is
+ * visible. */
+static void prv_compose_row(uint8_t *data, int min_x, int max_x, int y,
+                            const RoundyCompositorCell cells[ROUNDY_GRID_COLS]) {
+  (void)min_x;
+  const uint8_t background = prv_bits(roundy_palette_background_fill());
+  uint8_t *out = data;
+  uint32_t bits = 0;
+  int bit_count = 0;
+  if (y < ROUNDY_GRID_ROWS * ROUNDY_CELL_SIZE) {
+    const int idx = y % ROUNDY_CELL_SIZE;
+    for (int col = 0; col < ROUNDY_GRID_COLS; ++col) {
+      const RoundyCompositorCell *cell = &cells[col];
+      uint32_t pattern = prv_bits(cell->fill) & ((1u << ROUNDY_CELL_SIZE) - 1);
+      if (cell->rows & (1 << idx)) {
+        const uint32_t stroke_bit = 1u << cell->offsets[idx];
+        pattern = gcolor_equal(cell->stroke, GColorWhite) ? (pattern | stroke_bit)
+                                                          : (pattern & ~stroke_bit);
+      }
+      bits |= pattern << bit_count;
+      bit_count += ROUNDY_CELL_SIZE;
+      while (bit_count >= 8) {
+        *out++ = (uint8_t)bits;
+        bits >>= 8;
+        bit_count -= 8;
+      }
+    }
+  }
+  if (bit_count > 0) {
+    *out++ = (uint8_t)(bits | (background & (uint8_t)(0xFF << bit_count)));
+  }
+  uint8_t *end = data + ((max_x + 8) / 8);
+  if (out < end) {
+    memset(out, background, end - out);
+  }
+}
+
+#else
+
+/* Writes one framebuffer row, clipped to [min_x, max_x]. Only the cells in
+ * the row's visible span are read; anything outside it is background fill. */
+static void prv_compose_row(uint8_t *data, int min_x, int max_x, int y,
+                            const RoundyCompositorCell cells[ROUNDY_GRID_COLS]) {
+  const GColor background = roundy_palette_background_fill();
+  int x = min_x;
+  if (y < ROUNDY_GRID_ROWS * ROUNDY_CELL_SIZE) {
+    const int idx = y % ROUNDY_CELL_SIZE;
+    const RoundyCellSpan span = roundy_layout_row_span(y / ROUNDY_CELL_SIZE);
+    const int span_min_x = span.first_col * ROUNDY_CELL_SIZE;
+    const int span_max_x = span.end_col * ROUNDY_CELL_SIZE - 1;
+    for (; x < span_min_x && x <= max_x; ++x) {
+      prv_put_pixel(data, x, background);
+    }
+    const int last_x = (max_x < span_max_x) ? max_x : span_max_x;
+    for (int col = x / ROUNDY_CELL_SIZE; x <= last_x; ++col) {
+      const RoundyCompositorCell *cell = &cells[col];
+      const int cell_x = col * ROUNDY_CELL_SIZE;
+      const int stroke_x = cell_x + cell->offsets[idx];
+      const int end_x = (cell_x + ROUNDY_CELL_SIZE - 1 < last_x)
+                            ? cell_x + ROUNDY_CELL_SIZE - 1
+                            : last_x;
+      for (; x <= end_x; ++x) {
+        prv_put_pixel(data, x, (x == stroke_x) ? cell->stroke : cell->fill);
+      }
+    }
+  }
+  for (; x <= max_x; ++x) {
+    prv_put_pixel(data, x, background);
+  }
+}
+
+#endif
+
+/* Composes the frame straight into the framebuffer. Only possible when the
+ * layer covers the whole framebuffer, otherwise returns false. */
+static bool prv_draw_direct(RoundyCompositorLayer *compositor, GContext *ctx, GRect bounds) {
+  const GRect frame = layer_get_frame(compositor->layer);
+  if (frame.origin.x != 0 || frame.origin.y != 0) {
+    return false;
+  }
+
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) {
+    return false;
+  }
+
+  const GRect fb_bounds = gbitmap_get_bounds(fb);
+  const GBitmapFormat expected_format =
+      PBL_IF_ROUND_ELSE(GBitmapFormat8BitCircular,
+                        PBL_IF_COLOR_ELSE(GBitmapFormat8Bit, GBitmapFormat1Bit));
+  if (gbitmap_get_format(fb) != expected_format ||
+      fb_bounds.size.w != bounds.size.w || fb_bounds.size.h != bounds.size.h) {
+    graphics_release_frame_buffer(ctx, fb);
+    return false;
+  }
+
+  RoundyCompositorCell cells[ROUNDY_GRID_COLS];
+  int lit = 0;
+  uint32_t pixel_writes = 0;
+  for (int y = 0; y < bounds.size.h; ++y) {
+    if (y % ROUNDY_CELL_SIZE == 0 && y < ROUNDY_GRID_ROWS * ROUNDY_CELL_SIZE) {
+      lit += prv_resolve_row(compositor, y / ROUNDY_CELL_SIZE, cells);
+    }
+#if defined(PBL_ROUND)
+    /* chalk rows only hold the visible span of the circular display */
+    const GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, y);
+    prv_compose_row(info.data, info.min_x, info.max_x, y, cells);
+    pixel_writes += info.max_x - info.min_x + 1;
+#else
+    prv_compose_row(gbitmap_get_data(fb) + (y * gbitmap_get_bytes_per_row(fb)), 0,
+                    bounds.size.w - 1, y, cells);
+    pixel_writes += bounds.size.w;
+#endif
+  }
+  graphics_release_frame_buffer(ctx, fb);
+
+  /* stacked layers write the background everywhere and then every pixel of
+   * each lit cell again */
+  roundy_profile_count(RoundyProfileSectionCompositor, 0, pixel_writes);
+  roundy_profile_count_saved(RoundyProfileSectionCompositor,
+                             lit * ROUNDY_CELL_SIZE * ROUNDY_CELL_SIZE);
+  return true;
+}
+
+/* Fallback through the graphics context when the framebuffer is not usable;
+ * each cell is still only filled once. */
+static void prv_draw_cells(RoundyCompositorLayer *compositor, GContext *ctx, GRect bounds) {
+  const int grid_w = ROUNDY_GRID_COLS * ROUNDY_CELL_SIZE;
+  const int grid_h = ROUNDY_GRID_ROWS * ROUNDY_CELL_SIZE;
+  graphics_context_set_fill_color(ctx, roundy_palette_background_fill());
+  graphics_fill_rect(ctx, GRect(grid_w, 0, bounds.size.w - grid_w, bounds.size.h), 0,
+                     GCornerNone);
+  graphics_fill_rect(ctx, GRect(0, grid_h, grid_w, bounds.size.h - grid_h), 0, GCornerNone);
+
+  RoundyCompositorCell cells[ROUNDY_GRID_COLS];
+  int cell_count = 0;
+  for (int row = 0; row < ROUNDY_GRID_ROWS; ++row) {
+    prv_resolve_row(compositor, row, cells);
+    /* cells outside the span are never on screen, whatever they hold */
+    const RoundyCellSpan span = roundy_layout_row_span(row);
+    cell_count += span.end_col - span.first_col;
+    for (int col = span.first_col; col < span.end_col; ++col) {
+      const GRect frame = roundy_cell_frame(col, row);
+      graphics_context_set_fill_color(ctx, cells[col].fill);
+      graphics_fill_rect(ctx, frame, 0, GCornerNone);
+      graphics_context_set_stroke_color(ctx, cells[col].stroke);
+      for (int idx = 0; idx < ROUNDY_CELL_SIZE; ++idx) {
+        if (cells[col].rows & (1 << idx)) {
+          graphics_draw_pixel(ctx, GPoint(frame.origin.x + cells[col].offsets[idx],
+                                          frame.origin.y + idx));
+        }
+      }
+    }
+  }
+  roundy_profile_count(RoundyProfileSectionCompositor,
+                       2 + cell_count * (1 + ROUNDY_CELL_SIZE),
+                       bounds.size.w * bounds.size.h + cell_count * ROUNDY_CELL_SIZE);
+}
+
+static void prv_compositor_update_proc(Layer *layer, GContext *ctx) {
+  RoundyCompositorLayer *compositor = *(RoundyCompositorLayer **)layer_get_data(layer);
+  const GRect bounds = layer_get_bounds(layer);
+
+  roundy_trace(RoundyTraceEventUpdateBegin, RoundyTraceLayerCompositor);
+  const uint32_t start_ms = roundy_render_stats_begin();
+  roundy_frame_governor_render_begin();
+  roundy_profile_frame_begin(RoundyProfileSectionCompositor);
+  if (!prv_draw_direct(compositor, ctx, bounds)) {
+    prv_draw_cells(compositor, ctx, bounds);
+  }
+  roundy_profile_frame_end(RoundyProfileSectionCompositor);
+  roundy_frame_governor_render_end();
+  roundy_render_stats_end(RoundyProfileSectionCompositor, start_ms);
+  roundy_trace(RoundyTraceEventUpdateEnd, RoundyTraceLayerCompositor);
+}
+
+/* Allocates the wrapper, zeroed, and its Layer. */
+static RoundyCompositorLayer *prv_alloc(GRect frame) {
+#if defined(ROUNDY_STATIC_ALLOC)
+  if (s_compositor_layer_in_use) {
+    return NULL;
+  }
+
+  RoundyCompositorLayer *layer = &s_compositor_layer;
+  *layer = (RoundyCompositorLayer){.layer = layer->layer};
+  if (layer->layer) {
+    layer_set_frame(layer->layer, frame);
+  } else {
+    layer->layer = layer_create_with_data(frame, sizeof(RoundyCompositorLayer *));
+    if (!layer->layer) {
+      return NULL;
+    }
+  }
+  s_compositor_layer_in_use = true;
+#else
+  RoundyCompositorLayer *layer = calloc(1, sizeof(*layer));
+  if (!layer) {
+    return NULL;
+  }
+
+  layer->layer = layer_create_with_data(frame, sizeof(RoundyCompositorLayer *));
+  if (!layer->layer) {
+    free(layer);
+    return NULL;
+  }
+#endif
+  return layer;
+}
+
+/* Releases the wrapper and its Layer; the static ones are only detached. */
+static void prv_free(RoundyCompositorLayer *layer) {
+#if defined(ROUNDY_STATIC_ALLOC)
+  layer_remove_from_parent(layer->layer);
+  s_compositor_layer_in_use = false;
+#else
+  layer_destroy(layer->layer);
+  free(layer);
+#endif
+}
+
+RoundyCompositorLayer *roundy_compositor_layer_create(GRect frame, RoundyDigitLayer *digits) {
+  if (!digits) {
+    return NULL;
+  }
+
+  RoundyCompositorLayer *layer = prv_alloc(frame);
+  if (!layer) {
+    return NULL;
+  }
+
+  *(RoundyCompositorLayer **)layer_get_data(layer->layer) = layer;
+  layer->digits = digits;
+  prv_build_offsets(layer);
+  layer_set_update_proc(layer->layer, prv_compositor_update_proc);
+  roundy_digit_layer_set_compositor(digits, layer->layer);
+  return layer;
+}
+
+void roundy_compositor_layer_destroy(RoundyCompositorLayer *layer) {
+  if (!layer) {
+    return;
+  }
+
+  roundy_digit_layer_set_compositor(layer->digits, NULL);
+  prv_free(layer);
+}
+
+size_t roundy_compositor_layer_storage_size(void) {
+  return sizeof(RoundyCompositorLayer);
+}
+
+Layer *roundy_compositor_layer_get_layer(RoundyCompositorLayer *layer) {
+  return layer ? layer->layer : NULL;
+}
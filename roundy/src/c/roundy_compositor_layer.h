@@ -0,0 +1,18 @@
+#pragma once
+
+#include <pebble.h>
+
+#include "roundy_digit_layer.h"
+
+/* Draws the background grid and the digit cells in a single pass, writing
+ * every framebuffer pixel exactly once. Replaces the background layer and
+ * takes over drawing from the digit layer, which keeps running the
+ * animation. */
+typedef struct RoundyCompositorLayer RoundyCompositorLayer;
+
+RoundyCompositorLayer *roundy_compositor_layer_create(GRect frame, RoundyDigitLayer *digits);
+/* Must be destroyed before the digit layer it draws. */
+void roundy_compositor_layer_destroy(RoundyCompositorLayer *layer);
+Layer *roundy_compositor_layer_get_layer(RoundyCompositorLayer *layer);
+/* Bytes behind one compositor layer, see roundy_digit_layer_storage_size(). */
+size_t roundy_compositor_layer_storage_size(void);
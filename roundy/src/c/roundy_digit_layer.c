@@ -4,48 +4,133 @@
 #include <string.h>
 #include <time.h>
 
+#include "roundy_cell_atlas.h"
+#include "roundy_clock.h"
+#include "roundy_dither.h"
+#include "roundy_face_config.h"
+#include "roundy_frame_governor.h"
 #include "roundy_glyphs.h"
 #include "roundy_layout.h"
 #include "roundy_palette.h"
-#include <math.h>
+#include "roundy_persist.h"
+#include "roundy_profile.h"
+#include "roundy_progress.h"
+#include "roundy_render_stats.h"
+#include "roundy_trace.h"
 
-/* Animation tuning */
-#define DIAG_FRAME_MS 16 /* target frame interval in ms (approx 60Hz -> 16ms) */
-#define DIAG_DURATION_MS 480 /* total animation duration in ms (gradual reveal) */
-/* initial delay before starting the first animation frame (user requested value) */
-#define DIAG_START_DELAY_MS 240
-#define ROUNDY_GLYPH_DURATION 1.0f
-#define ROUNDY_GLYPH_STAGGER 1.0f
+/* Animation tuning comes from the face; frames after the first are paced by
+ * roundy_frame_governor */
+#define ROUNDY_GLYPH_DURATION_MS ROUNDY_FACE_GLYPH_DURATION_MS
+#define ROUNDY_GLYPH_STAGGER_MS ROUNDY_FACE_GLYPH_STAGGER_MS
+
+_Static_assert(ROUNDY_GLYPH_DURATION_MS > 0, "a glyph flip needs a duration");
 
 /* digits + colon */
 #define ROUNDY_ANIMATED_GLYPH_COUNT (ROUNDY_DIGIT_COUNT + 1)
+#define ROUNDY_DIAG_TOTAL_MS \
+  ((ROUNDY_ANIMATED_GLYPH_COUNT - 1) * ROUNDY_GLYPH_STAGGER_MS + ROUNDY_GLYPH_DURATION_MS)
 
-/* choose animation color based on progress: three steps
- * 0.0 - 0.333: #555555
- * 0.333 - 0.666: #AAAAAA
- * 0.666 - 1.0: #FFFFFF
- */
-static GColor prv_anim_color(float p) {
-  if (p < (1.0f / 3.0f)) {
-    return PBL_IF_COLOR_ELSE(GColorFromRGB(0x55, 0x55, 0x55), GColorBlack);
-  } else if (p < (2.0f / 3.0f)) {
-    return PBL_IF_COLOR_ELSE(GColorFromRGB(0xAA, 0xAA, 0xAA), GColorBlack);
-  } else {
-    return PBL_IF_COLOR_ELSE(GColorFromRGB(0xFF, 0xFF, 0xFF), GColorWhite);
+static GColor prv_cell_color(RoundyCellColor color) {
+  return (color == RoundyCellColorStroke)
+             ? roundy_palette_digit_stroke()
+             : roundy_palette_gradient_color(color - RoundyCellColorGradient);
+}
+
+/* Grey level of a colour row, see roundy_dither.h. */
+static uint8_t prv_cell_level(RoundyCellColor color) {
+  if (color == RoundyCellColorStroke) {
+    return gcolor_equal(roundy_palette_digit_stroke(), GColorWhite) ? ROUNDY_DITHER_LEVELS : 0;
   }
+  return roundy_palette_gradient_level(color - RoundyCellColorGradient);
 }
 
+/* Atlas row of an animating cell at `progress` < 1: a table lookup in the
+ * current palette theme's gradient. */
+static inline RoundyCellColor prv_anim_color_index(RoundyProgress progress) {
+  return (RoundyCellColor)(RoundyCellColorGradient + roundy_palette_gradient_step(progress));
+}
+
+/* Retained cell state, one byte per grid cell: 0 for an empty cell,
+ * otherwise the cell's colour plus one and its diagonal step. CELL_TOUCHED is
+ * only set while a frame is being composed. */
+#define CELL_TOUCHED 0x80
+#define CELL_COLOR_SHIFT 4
+#define CELL_COLOR_MASK 0x70
+#define CELL_STEP_MASK 0x0F
+#define CELL_LIT(cell) (((cell) & CELL_COLOR_MASK) != 0)
+#define CELL_COLOR(cell) \
+  ((RoundyCellColor)((((cell) & CELL_COLOR_MASK) >> CELL_COLOR_SHIFT) - 1))
+
+_Static_assert(ROUNDY_CELL_MAX_STEPS <= CELL_STEP_MASK + 1, "cell step does not fit");
+_Static_assert(RoundyCellColorCount < (CELL_COLOR_MASK >> CELL_COLOR_SHIFT) + 1,
+               "cell colour does not fit");
+
+/* Digits are packed four bits each, digit 0 in the low bits; DIGIT_BLANK is
+ * a digit that is not shown, such as the leading zero in 12h mode. */
+#define DIGIT_BITS 4
+#define DIGIT_MASK 0x0F
+#define DIGIT_BLANK 0x0F
+/* Each glyph starts a whole number of ROUNDY_GLYPH_STAGGER_MS into the
+ * timeline; that number is packed three bits per glyph. */
+#define GLYPH_SLOT_BITS 3
+#define GLYPH_SLOT_MASK 0x07
+
+typedef enum {
+  RoundyDigitAnimGlyphs = 0,
+  RoundyDigitAnimDiag,
+} RoundyDigitAnimMode;
+
+/* Everything the digits and their animation need between two frames. The
+ * timeline is wall-clock milliseconds since epoch_ms, so late frames are
+ * skipped rather than replayed; timeline values never pass end_ms, which is
+ * why 16 bits hold them. */
 typedef struct {
-  int16_t digits[ROUNDY_DIGIT_COUNT];
-  int16_t prev_digits[ROUNDY_DIGIT_COUNT];
-  bool use_24h_time;
-  /* animation state */
+  uint32_t epoch_ms;
+  /* wall clock when the animation was requested, for the intended vs actual
+   * duration report */
+  uint32_t requested_ms;
+  uint16_t digits;
+  uint16_t prev_digits;
+  uint16_t glyph_slots;
+  /* timeline time at which the running animation has finished */
+  int16_t end_ms;
+  /* timeline time of the current frame, for the per-glyph and the diagonal
+   * animation respectively */
+  int16_t time_ms;
+  int16_t diag_time_ms;
+  uint16_t delay_ms;
+  /* one bit per glyph slot */
+  uint8_t glyph_active;
+  uint8_t mode : 1;
+  uint8_t use_24h_time : 1;
+  uint8_t clock_format : 2;
+  /* show new digits at once instead of animating them */
+  uint8_t instant : 1;
+} RoundyDigitAnim;
+
+_Static_assert(sizeof(RoundyDigitAnim) <= 32, "animation state outgrew 32 bytes");
+_Static_assert(ROUNDY_DIGIT_COUNT * DIGIT_BITS <= 16, "digits do not fit");
+_Static_assert(ROUNDY_GLYPH_NINE < DIGIT_BLANK, "digit values collide with DIGIT_BLANK");
+_Static_assert(ROUNDY_ANIMATED_GLYPH_COUNT * GLYPH_SLOT_BITS <= 16, "glyph slots do not fit");
+_Static_assert(ROUNDY_ANIMATED_GLYPH_COUNT <= GLYPH_SLOT_MASK + 1, "glyph slot too narrow");
+_Static_assert(ROUNDY_DIAG_TOTAL_MS <= INT16_MAX, "timeline does not fit 16 bits");
+_Static_assert(ROUNDY_FACE_INTRO_DELAY_MS <= UINT16_MAX &&
+               ROUNDY_FACE_MINUTE_DELAY_MS <= UINT16_MAX, "start delay does not fit");
+
+typedef struct {
+  RoundyDigitAnim anim;
   AppTimer *anim_timer;
-  float anim_time;
-  float glyph_start[ROUNDY_ANIMATED_GLYPH_COUNT];
-  bool glyph_active[ROUNDY_ANIMATED_GLYPH_COUNT];
-  bool diag_mode_active;
-  float diag_time;
+  /* timeline ms that pass per 100 wall clock ms */
+  uint16_t speed_percent;
+  /* pre-rendered animating cells, NULL if it could not be allocated */
+  RoundyCellAtlas *atlas;
+  /* what the layer shows, recomposed on every animation tick and drawn by
+   * the update proc */
+  uint8_t cells[ROUNDY_GRID_ROWS * ROUNDY_GRID_COLS];
+  bool cells_changed;
+  /* layer that draws the cells instead of this one, see
+   * roundy_digit_layer_set_compositor() */
+  Layer *compositor;
 } RoundyDigitLayerState;
 
 struct RoundyDigitLayer {
@@ -53,33 +138,71 @@ struct RoundyDigitLayer {
   RoundyDigitLayerState *state;
 };
 
+#define GLYPH_BIT(glyph_index) ((uint8_t)(1 << (glyph_index)))
+
+_Static_assert(ROUNDY_ANIMATED_GLYPH_COUNT <= 8, "glyph bits do not fit");
+
 static void prv_diag_anim_timer(void *ctx);
+static void prv_update_cells(Layer *layer, RoundyDigitLayerState *state);
+
+#if defined(ROUNDY_STATIC_ALLOC)
+/* the only digit layer; the Layer's data just points at the state. The Layer
+ * is created once and kept across destroy() and create(). */
+static RoundyDigitLayer s_digit_layer;
+static RoundyDigitLayerState s_digit_state;
+static bool s_digit_layer_in_use;
+#endif
 
 static inline RoundyDigitLayerState *prv_get_state(RoundyDigitLayer *layer) {
   return layer ? layer->state : NULL;
 }
 
-static float prv_glyph_progress(const RoundyDigitLayerState *state, int glyph_index) {
-  if (!state->glyph_active[glyph_index]) {
-    return 1.0f;
-  }
-  const float elapsed = state->anim_time - state->glyph_start[glyph_index];
-  if (elapsed <= 0.0f) {
-    return 0.0f;
-  }
-  if (elapsed >= ROUNDY_GLYPH_DURATION) {
-    return 1.0f;
-  }
-  return elapsed / ROUNDY_GLYPH_DURATION;
+static inline RoundyDigitLayerState *prv_layer_state(const Layer *layer) {
+#if defined(ROUNDY_STATIC_ALLOC)
+  return *(RoundyDigitLayerState **)layer_get_data(layer);
+#else
+  return layer_get_data(layer);
+#endif
 }
 
-static bool prv_any_glyph_active(const RoundyDigitLayerState *state) {
-  for (int i = 0; i < ROUNDY_ANIMATED_GLYPH_COUNT; ++i) {
-    if (state->glyph_active[i]) {
-      return true;
+/* Digit `index` of a packed digit set, -1 if blank. */
+static inline int16_t prv_digit(uint16_t digits, int index) {
+  const int value = (digits >> (index * DIGIT_BITS)) & DIGIT_MASK;
+  return (value == DIGIT_BLANK) ? -1 : (int16_t)value;
+}
+
+static inline uint16_t prv_with_digit(uint16_t digits, int index, int16_t digit) {
+  const int shift = index * DIGIT_BITS;
+  const uint16_t value = (digit < 0) ? DIGIT_BLANK : (uint16_t)digit;
+  return (uint16_t)((digits & ~(DIGIT_MASK << shift)) | (value << shift));
+}
+
+/* Whether every digit of a packed set is 0-9 or blank. */
+static bool prv_digits_are_valid(uint16_t digits) {
+  for (int index = 0; index < ROUNDY_DIGIT_COUNT; ++index) {
+    if (prv_digit(digits, index) > ROUNDY_GLYPH_NINE) {
+      return false;
     }
   }
-  return false;
+  return true;
+}
+
+static inline bool prv_glyph_active(const RoundyDigitAnim *anim, int glyph_index) {
+  return anim->glyph_active & GLYPH_BIT(glyph_index);
+}
+
+static inline int32_t prv_glyph_start_ms(const RoundyDigitAnim *anim, int glyph_index) {
+  const int slot = (anim->glyph_slots >> (glyph_index * GLYPH_SLOT_BITS)) & GLYPH_SLOT_MASK;
+  return slot * ROUNDY_GLYPH_STAGGER_MS;
+}
+
+static RoundyProgress prv_glyph_progress(const RoundyDigitLayerState *state,
+                                         int glyph_index) {
+  if (!prv_glyph_active(&state->anim, glyph_index)) {
+    return ROUNDY_PROGRESS_ONE;
+  }
+  return roundy_progress(state->anim.time_ms - prv_glyph_start_ms(&state->anim, glyph_index),
+                      ROUNDY_GLYPH_DURATION_MS);
 }
 
 static void prv_configure_glyph_animation(RoundyDigitLayerState *state, const bool mask[]) {
@@ -87,60 +210,94 @@ static void prv_configure_glyph_animation(RoundyDigitLayerState *state, const bo
     return;
   }
 
-  state->diag_mode_active = false;
-  state->diag_time = 0.0f;
-  state->anim_time = 0.0f;
-  float next_start = 0.0f;
+  RoundyDigitAnim *anim = &state->anim;
+  anim->mode = RoundyDigitAnimGlyphs;
+  anim->diag_time_ms = 0;
+  anim->time_ms = 0;
+  anim->end_ms = 0;
+  anim->glyph_active = 0;
+  anim->glyph_slots = 0;
+  int next_slot = 0;
   for (int i = 0; i < ROUNDY_ANIMATED_GLYPH_COUNT; ++i) {
     if (mask[i]) {
-      state->glyph_active[i] = true;
-      state->glyph_start[i] = next_start;
-      next_start += ROUNDY_GLYPH_STAGGER;
-    } else {
-      state->glyph_active[i] = false;
-      state->glyph_start[i] = 0.0f;
+      anim->glyph_active |= GLYPH_BIT(i);
+      anim->glyph_slots |= (uint16_t)(next_slot << (i * GLYPH_SLOT_BITS));
+      anim->end_ms = (int16_t)(next_slot * ROUNDY_GLYPH_STAGGER_MS + ROUNDY_GLYPH_DURATION_MS);
+      ++next_slot;
     }
   }
 }
 
+/* Start the timeline `delay_ms` from now and schedule its first frame. */
+static void prv_start_timeline(Layer *layer, RoundyDigitLayerState *state,
+                               uint32_t delay_ms) {
+  state->anim.requested_ms = roundy_clock_now_ms();
+  state->anim.delay_ms = (uint16_t)delay_ms;
+  state->anim.epoch_ms = roundy_clock_timeline_ms() + delay_ms;
+  roundy_frame_governor_reset();
+  roundy_trace(RoundyTraceEventTimerRegister, delay_ms);
+  state->anim_timer = roundy_clock_timer_register(delay_ms, prv_diag_anim_timer, layer);
+}
+
+/* Stop any animation and show the current digits settled. */
+static void prv_settle(RoundyDigitLayerState *state) {
+  if (state->anim_timer) {
+    roundy_trace(RoundyTraceEventTimerCancel, 0);
+    app_timer_cancel(state->anim_timer);
+    state->anim_timer = NULL;
+  }
+  RoundyDigitAnim *anim = &state->anim;
+  anim->mode = RoundyDigitAnimGlyphs;
+  anim->glyph_active = 0;
+  anim->time_ms = ROUNDY_GLYPH_DURATION_MS;
+  anim->diag_time_ms = ROUNDY_DIAG_TOTAL_MS;
+}
+
+static int32_t prv_timeline_ms(const RoundyDigitLayerState *state) {
+  const int32_t time_ms = (int32_t)(roundy_clock_timeline_ms() - state->anim.epoch_ms);
+  return (time_ms < 0) ? 0 : (time_ms * state->speed_percent) / 100;
+}
+
+/* Wall clock time that `timeline_ms` of the timeline take, rounded up. */
+static int32_t prv_wall_ms(const RoundyDigitLayerState *state, int32_t timeline_ms) {
+  return ((timeline_ms * 100) + state->speed_percent - 1) / state->speed_percent;
+}
+
 static void prv_start_glyph_animation(RoundyDigitLayer *rdl, const bool mask[],
                                       uint32_t initial_delay_ms) {
   if (!rdl || !rdl->layer) {
     return;
   }
-  RoundyDigitLayerState *state = layer_get_data(rdl->layer);
+  RoundyDigitLayerState *state = prv_layer_state(rdl->layer);
   if (!state) {
     return;
   }
 
   if (state->anim_timer) {
+    roundy_trace(RoundyTraceEventTimerCancel, 0);
     app_timer_cancel(state->anim_timer);
     state->anim_timer = NULL;
   }
 
   prv_configure_glyph_animation(state, mask);
 
-  if (!prv_any_glyph_active(state)) {
-    layer_mark_dirty(rdl->layer);
+  if (state->anim.instant && state->anim.glyph_active) {
+    roundy_frame_governor_count_skipped(initial_delay_ms +
+                                        (uint32_t)prv_wall_ms(state, state->anim.end_ms));
+    prv_settle(state);
+  }
+  if (!state->anim.glyph_active) {
+    prv_update_cells(rdl->layer, state);
     return;
   }
 
-  state->anim_timer =
-      app_timer_register(initial_delay_ms, prv_diag_anim_timer, rdl->layer);
-  layer_mark_dirty(rdl->layer);
+  prv_start_timeline(rdl->layer, state, initial_delay_ms);
+  prv_update_cells(rdl->layer, state);
 }
 
-static float prv_diag_glyph_progress(float time, int glyph_index) {
-  const float start = (float)glyph_index * ROUNDY_GLYPH_STAGGER;
-  const float local = time - start;
-  if (local <= 0.0f) {
-    return 0.0f;
-  }
-  float progress = local / ROUNDY_GLYPH_DURATION;
-  if (progress >= 1.0f) {
-    return 1.0f;
-  }
-  return progress;
+static RoundyProgress prv_diag_glyph_progress(int32_t time_ms, int glyph_index) {
+  return roundy_progress(time_ms - glyph_index * ROUNDY_GLYPH_STAGGER_MS,
+                      ROUNDY_GLYPH_DURATION_MS);
 }
 
 static inline int prv_digit_index_for_glyph(int glyph_index) {
@@ -157,89 +314,139 @@ static inline int prv_digit_index_for_glyph(int glyph_index) {
 }
 
 /* Draw a single digit cell. `progress` interpolates the diagonal from the
- * original '\' (progress == 0) to '/' (progress == 1). */
+ * original '\' (progress == 0) to '/' (progress == 1); only the rows set in
+ * `rows` get their stroke pixel. */
 static void prv_draw_digit_cell(GContext *ctx, int cell_col, int cell_row,
-                                float progress) {
+                                RoundyProgress progress, uint8_t rows) {
   const GRect frame = roundy_cell_frame(cell_col, cell_row);
   graphics_fill_rect(ctx, frame, 0, GCornerNone);
 
   const int origin_x = frame.origin.x;
   const int origin_y = frame.origin.y;
   for (int idx = 0; idx < ROUNDY_CELL_SIZE; ++idx) {
+    if (!(rows & (1 << idx))) {
+      continue;
+    }
     /* interpolate between '\' and '/' diagonals */
-    const int from_x = idx;
-    const int to_x = (ROUNDY_CELL_SIZE - 1 - idx);
-    const int x =
-        origin_x + (int)roundf(((1.0f - progress) * from_x) + (progress * to_x));
+    const int x = origin_x + roundy_progress_diag_offset(progress, idx);
     const int y = origin_y + idx;
     graphics_draw_pixel(ctx, GPoint(x, y));
   }
 }
 
-static void prv_draw_glyph(GContext *ctx, const RoundyGlyph *glyph, int cell_col,
-                           int cell_row, float progress, GColor base_stroke) {
-  if (!glyph) {
+static void prv_draw_cell(GContext *ctx, int cell_col, int cell_row, RoundyCellColor color,
+                          int step, GColor base_stroke, RoundyCellAtlas *atlas) {
+  if (atlas) {
+    roundy_cell_atlas_draw(atlas, ctx, roundy_cell_frame(cell_col, cell_row), step, color);
+    roundy_profile_count(RoundyProfileSectionDigits, 1, ROUNDY_CELL_SIZE * ROUNDY_CELL_SIZE);
     return;
   }
 
-  const int max_diag = (glyph->width - 1) + (ROUNDY_DIGIT_HEIGHT - 1);
-  const float total = progress * (float)(max_diag + 1);
+#if defined(PBL_BW)
+  (void)base_stroke;
+  graphics_context_set_stroke_color(ctx, GColorWhite);
+  const uint8_t rows = roundy_dither_rows(prv_cell_level(color));
+#else
+  const GColor stroke =
+      (color == RoundyCellColorStroke) ? base_stroke : prv_cell_color(color);
+  graphics_context_set_stroke_color(ctx, stroke);
+  const uint8_t rows = (1 << ROUNDY_CELL_SIZE) - 1;
+#endif
+  prv_draw_digit_cell(ctx, cell_col, cell_row, roundy_cell_step_progress(step), rows);
+  roundy_profile_count(RoundyProfileSectionDigits, 1 + ROUNDY_CELL_SIZE,
+                       (ROUNDY_CELL_SIZE + 1) * ROUNDY_CELL_SIZE);
+}
 
-  for (int row = 0; row < ROUNDY_DIGIT_HEIGHT; ++row) {
-    const uint8_t mask = glyph->rows[row];
-    if (!mask) {
-      continue;
-    }
+static void prv_set_cell(RoundyDigitLayerState *state, int cell_col, int cell_row,
+                         RoundyCellColor color, int step) {
+  if (cell_col < 0 || cell_row < 0 || cell_col >= ROUNDY_GRID_COLS ||
+      cell_row >= ROUNDY_GRID_ROWS) {
+    return;
+  }
+
+  uint8_t *cell = &state->cells[(cell_row * ROUNDY_GRID_COLS) + cell_col];
+  const uint8_t value = (uint8_t)((color + 1) << CELL_COLOR_SHIFT) | (uint8_t)step;
+  if ((*cell & ~CELL_TOUCHED) != value) {
+    state->cells_changed = true;
+  }
+  *cell = value | CELL_TOUCHED;
+}
 
-  for (int col = 0; col < glyph->width; ++col) {
-      if (mask & (1 << (glyph->width - 1 - col))) {
-        const int diag_index = row + col;
-        float cell_progress = total - (float)diag_index;
-        if (cell_progress <= 0.0f) {
-          continue;
-        }
-        if (cell_progress > 1.0f) {
-          cell_progress = 1.0f;
-        }
-        const GColor stroke =
-            (cell_progress >= 1.0f) ? base_stroke : prv_anim_color(cell_progress);
-        graphics_context_set_stroke_color(ctx, stroke);
-        prv_draw_digit_cell(ctx, cell_col + col, cell_row + row, cell_progress);
+/* Compose the subset `cells` of glyph `glyph_id`, revealed along its
+ * diagonals. Only the diagonals the reveal has reached are visited. */
+static void prv_compose_glyph(RoundyDigitLayerState *state, int glyph_id,
+                              RoundyBitboard cells, int cell_col, int cell_row,
+                              RoundyProgress progress) {
+  const RoundyGlyph *glyph = &ROUNDY_GLYPHS[glyph_id];
+  cells &= glyph->cells;
+  if (!cells) {
+    return;
+  }
+
+  const RoundyGlyphSpans *spans = &ROUNDY_GLYPH_SPANS[glyph_id];
+  const RoundyGlyphCell *glyph_cells = &ROUNDY_GLYPH_CELLS[spans->first_cell];
+  const int diag_count = glyph->width + ROUNDY_DIGIT_HEIGHT - 1;
+  const RoundyProgress total = progress * diag_count;
+
+  /* diagonal d has started once total > d */
+  int started = (int)((total + ROUNDY_PROGRESS_ONE - 1) >> ROUNDY_PROGRESS_SHIFT);
+  if (started > diag_count) {
+    started = diag_count;
+  }
+
+  for (int diag = 0; diag < started; ++diag) {
+    RoundyProgress cell_progress = total - (diag * ROUNDY_PROGRESS_ONE);
+    if (cell_progress > ROUNDY_PROGRESS_ONE) {
+      cell_progress = ROUNDY_PROGRESS_ONE;
+    }
+    const RoundyCellColor color = (cell_progress >= ROUNDY_PROGRESS_ONE)
+                                      ? RoundyCellColorStroke
+                                      : prv_anim_color_index(cell_progress);
+    const int step = roundy_cell_step(cell_progress);
+
+    for (int i = spans->diag_start[diag]; i < spans->diag_start[diag + 1]; ++i) {
+      const RoundyGlyphCell cell = glyph_cells[i];
+      if (cells & roundy_glyph_cell_bit(cell.row, cell.col)) {
+        prv_set_cell(state, cell_col + cell.col, cell_row + cell.row, color, step);
       }
     }
   }
-  graphics_context_set_stroke_color(ctx, base_stroke);
 }
 
-static void prv_draw_digit(GContext *ctx, int16_t digit, int cell_col,
-                           int cell_row, float progress, GColor base_stroke) {
+static void prv_compose_digit_cells(RoundyDigitLayerState *state, int16_t digit,
+                                    RoundyBitboard cells, int cell_col, int cell_row,
+                                    RoundyProgress progress) {
   if (digit < ROUNDY_GLYPH_ZERO || digit > ROUNDY_GLYPH_NINE) {
     return;
   }
 
-  prv_draw_glyph(ctx, &ROUNDY_GLYPHS[digit], cell_col, cell_row, progress,
-                 base_stroke);
+  prv_compose_glyph(state, digit, cells, cell_col, cell_row, progress);
+}
+
+static void prv_compose_digit(RoundyDigitLayerState *state, int16_t digit, int cell_col,
+                              int cell_row, RoundyProgress progress) {
+  prv_compose_digit_cells(state, digit, roundy_glyph_cells(digit), cell_col, cell_row,
+                          progress);
 }
 
-static void prv_draw_colon(GContext *ctx, int cell_col, int cell_row,
-                           float progress, GColor base_stroke) {
-  prv_draw_glyph(ctx, &ROUNDY_GLYPHS[ROUNDY_GLYPH_COLON], cell_col, cell_row,
-                 progress, base_stroke);
+static void prv_compose_colon(RoundyDigitLayerState *state, int cell_col, int cell_row,
+                              RoundyProgress progress) {
+  prv_compose_glyph(state, ROUNDY_GLYPH_COLON, roundy_glyph_cells(ROUNDY_GLYPH_COLON),
+                    cell_col, cell_row, progress);
 }
 
-static void prv_draw_glyph_slot(GContext *ctx, RoundyDigitLayerState *state,
-                                int glyph_index, int cell_col, int cell_row,
-                                GColor base_stroke) {
-  const bool animating = state->glyph_active[glyph_index];
-  float progress = prv_glyph_progress(state, glyph_index);
+static void prv_compose_glyph_slot(RoundyDigitLayerState *state, int glyph_index,
+                                   int cell_col, int cell_row) {
+  const bool animating = prv_glyph_active(&state->anim, glyph_index);
+  const RoundyProgress progress = prv_glyph_progress(state, glyph_index);
   if (!animating) {
     if (glyph_index == 2) {
-      prv_draw_colon(ctx, cell_col, cell_row, 1.0f, base_stroke);
+      prv_compose_colon(state, cell_col, cell_row, ROUNDY_PROGRESS_ONE);
     } else {
       const int digit_idx = prv_digit_index_for_glyph(glyph_index);
       if (digit_idx >= 0) {
-        prv_draw_digit(ctx, state->digits[digit_idx], cell_col, cell_row, 1.0f,
-                       base_stroke);
+        prv_compose_digit(state, prv_digit(state->anim.digits, digit_idx), cell_col, cell_row,
+                          ROUNDY_PROGRESS_ONE);
       }
     }
     return;
@@ -247,136 +454,184 @@ static void prv_draw_glyph_slot(GContext *ctx, RoundyDigitLayerState *state,
 
   if (glyph_index == 2) {
     /* colon only animates in one direction */
-    prv_draw_colon(ctx, cell_col, cell_row, progress, base_stroke);
+    prv_compose_colon(state, cell_col, cell_row, progress);
     return;
   }
-
   const int digit_idx = prv_digit_index_for_glyph(glyph_index);
   if (digit_idx < 0) {
     return;
   }
 
-  const int16_t new_digit = state->digits[digit_idx];
-  const int16_t old_digit = state->prev_digits[digit_idx];
+  const int16_t new_digit = prv_digit(state->anim.digits, digit_idx);
+  const int16_t old_digit = prv_digit(state->anim.prev_digits, digit_idx);
 
   const bool has_old = (old_digit >= ROUNDY_GLYPH_ZERO &&
                         old_digit <= ROUNDY_GLYPH_NINE);
   const bool has_new = (new_digit >= ROUNDY_GLYPH_ZERO &&
                         new_digit <= ROUNDY_GLYPH_NINE);
 
-  const float phase = progress * 2.0f; /* 0-2 */
+  /* cells shared by both digits stay lit, only the difference animates: the
+   * removed cells exit during the first half, the added ones enter in the
+   * second half */
+  const RoundyGlyphTransition plan = roundy_glyph_plan_transition(old_digit, new_digit);
+  prv_compose_digit_cells(state, new_digit, plan.kept, cell_col, cell_row,
+                          ROUNDY_PROGRESS_ONE);
+
+  const RoundyProgress phase = progress * 2; /* 0-2 */
 
   if (has_old) {
-    const float exit_phase = phase;
-    if (exit_phase < 1.0f) {
-      float exit_progress = 1.0f - exit_phase;
-      if (exit_progress < 0.0f) {
-        exit_progress = 0.0f;
-      } else if (exit_progress > 1.0f) {
-        exit_progress = 1.0f;
+    const RoundyProgress exit_phase = phase;
+    if (exit_phase < ROUNDY_PROGRESS_ONE) {
+      RoundyProgress exit_progress = ROUNDY_PROGRESS_ONE - exit_phase;
+      if (exit_progress < 0) {
+        exit_progress = 0;
+      } else if (exit_progress > ROUNDY_PROGRESS_ONE) {
+        exit_progress = ROUNDY_PROGRESS_ONE;
       }
-      prv_draw_digit(ctx, old_digit, cell_col, cell_row, exit_progress,
-                     base_stroke);
+      prv_compose_digit_cells(state, old_digit, plan.removed, cell_col, cell_row,
+                              exit_progress);
     }
   }
 
   if (has_new) {
-    const float enter_start = has_old ? 1.0f : 0.0f;
+    const RoundyProgress enter_start = has_old ? ROUNDY_PROGRESS_ONE : 0;
     if (phase >= enter_start) {
-      float enter_phase = phase - enter_start;
-      if (enter_phase < 0.0f) {
-        enter_phase = 0.0f;
-      } else if (enter_phase > 1.0f) {
-        enter_phase = 1.0f;
+      RoundyProgress enter_phase = phase - enter_start;
+      if (enter_phase < 0) {
+        enter_phase = 0;
+      } else if (enter_phase > ROUNDY_PROGRESS_ONE) {
+        enter_phase = ROUNDY_PROGRESS_ONE;
       }
-      prv_draw_digit(ctx, new_digit, cell_col, cell_row, enter_phase,
-                     base_stroke);
+      prv_compose_digit_cells(state, new_digit, plan.added, cell_col, cell_row,
+                              enter_phase);
     }
   }
 }
 
-static void prv_digit_layer_update_proc(Layer *layer, GContext *ctx) {
-  RoundyDigitLayerState *state = layer_get_data(layer);
-  if (!state) {
-    return;
-  }
-
-  graphics_context_set_fill_color(ctx, roundy_palette_digit_fill());
+/* Recompose the cell buffer for the current animation time. Returns whether
+ * any cell differs from the previous frame. */
+static bool prv_compose_cells(RoundyDigitLayerState *state) {
+  state->cells_changed = false;
   const int cell_row = ROUNDY_DIGIT_START_ROW;
 
-  if (state->diag_mode_active) {
-    const float diag_total = (ROUNDY_ANIMATED_GLYPH_COUNT - 1) * ROUNDY_GLYPH_STAGGER + ROUNDY_GLYPH_DURATION;
-    float color_phase = state->diag_time / diag_total;
-    if (color_phase > 1.0f) {
-      color_phase = 1.0f;
-    } else if (color_phase < 0.0f) {
-      color_phase = 0.0f;
-    }
-    const GColor base_stroke = roundy_palette_digit_stroke();
-    graphics_context_set_stroke_color(ctx, prv_anim_color(color_phase));
-
+  const RoundyDigitAnim *anim = &state->anim;
+  if (anim->mode == RoundyDigitAnimDiag) {
     int cell_col = ROUNDY_DIGIT_START_COL;
-    float glyph_progress = prv_diag_glyph_progress(state->diag_time, 0);
-    if (state->digits[0] >= ROUNDY_GLYPH_ZERO &&
-        state->digits[0] <= ROUNDY_GLYPH_NINE) {
-      prv_draw_digit(ctx, state->digits[0], cell_col, cell_row, glyph_progress,
-                     base_stroke);
-    }
+    prv_compose_digit(state, prv_digit(anim->digits, 0), cell_col, cell_row,
+                      prv_diag_glyph_progress(anim->diag_time_ms, 0));
     cell_col += ROUNDY_DIGIT_WIDTH + ROUNDY_DIGIT_GAP;
 
-    glyph_progress = prv_diag_glyph_progress(state->diag_time, 1);
-    if (state->digits[1] >= ROUNDY_GLYPH_ZERO &&
-        state->digits[1] <= ROUNDY_GLYPH_NINE) {
-      prv_draw_digit(ctx, state->digits[1], cell_col, cell_row, glyph_progress,
-                     base_stroke);
-    }
+    prv_compose_digit(state, prv_digit(anim->digits, 1), cell_col, cell_row,
+                      prv_diag_glyph_progress(anim->diag_time_ms, 1));
     cell_col += ROUNDY_DIGIT_WIDTH + ROUNDY_DIGIT_GAP;
 
-    glyph_progress = prv_diag_glyph_progress(state->diag_time, 2);
-    prv_draw_colon(ctx, cell_col, cell_row, glyph_progress, base_stroke);
+    prv_compose_colon(state, cell_col, cell_row,
+                      prv_diag_glyph_progress(anim->diag_time_ms, 2));
     cell_col += ROUNDY_DIGIT_COLON_WIDTH + ROUNDY_DIGIT_GAP;
 
-    glyph_progress = prv_diag_glyph_progress(state->diag_time, 3);
-    if (state->digits[2] >= ROUNDY_GLYPH_ZERO &&
-        state->digits[2] <= ROUNDY_GLYPH_NINE) {
-      prv_draw_digit(ctx, state->digits[2], cell_col, cell_row, glyph_progress,
-                     base_stroke);
-    }
+    prv_compose_digit(state, prv_digit(anim->digits, 2), cell_col, cell_row,
+                      prv_diag_glyph_progress(anim->diag_time_ms, 3));
     cell_col += ROUNDY_DIGIT_WIDTH + ROUNDY_DIGIT_GAP;
 
-    glyph_progress = prv_diag_glyph_progress(state->diag_time, 4);
-    if (state->digits[3] >= ROUNDY_GLYPH_ZERO &&
-        state->digits[3] <= ROUNDY_GLYPH_NINE) {
-      prv_draw_digit(ctx, state->digits[3], cell_col, cell_row, glyph_progress,
-                     base_stroke);
+    prv_compose_digit(state, prv_digit(anim->digits, 3), cell_col, cell_row,
+                      prv_diag_glyph_progress(anim->diag_time_ms, 4));
+  } else {
+    int cell_col = ROUNDY_DIGIT_START_COL;
+    for (int glyph_index = 0; glyph_index < ROUNDY_ANIMATED_GLYPH_COUNT;
+         ++glyph_index) {
+      prv_compose_glyph_slot(state, glyph_index, cell_col, cell_row);
+      switch (glyph_index) {
+        case 0:
+        case 1:
+        case 3:
+          cell_col += ROUNDY_DIGIT_WIDTH + ROUNDY_DIGIT_GAP;
+          break;
+        case 2:
+          cell_col += ROUNDY_DIGIT_COLON_WIDTH + ROUNDY_DIGIT_GAP;
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  /* clear the cells this frame did not touch */
+  for (size_t i = 0; i < sizeof(state->cells); ++i) {
+    if (state->cells[i] & CELL_TOUCHED) {
+      state->cells[i] &= (uint8_t)~CELL_TOUCHED;
+    } else if (state->cells[i]) {
+      state->cells[i] = 0;
+      state->cells_changed = true;
     }
+  }
+  return state->cells_changed;
+}
+
+/* Recompose the cells and only redraw when the frame actually changed. */
+static void prv_update_cells(Layer *layer, RoundyDigitLayerState *state) {
+  if (!prv_compose_cells(state)) {
     return;
   }
 
-  const GColor base_stroke = roundy_palette_digit_stroke();
-  graphics_context_set_stroke_color(ctx, base_stroke);
+  if (state->compositor) {
+    roundy_trace(RoundyTraceEventMarkDirty, RoundyTraceLayerCompositor);
+    layer_mark_dirty(state->compositor);
+  } else {
+    roundy_trace(RoundyTraceEventMarkDirty, RoundyTraceLayerDigits);
+    layer_mark_dirty(layer);
+  }
+}
+
+static void prv_digit_layer_update_proc(Layer *layer, GContext *ctx) {
+  RoundyDigitLayerState *state = prv_layer_state(layer);
+  if (!state || state->compositor) {
+    return;
+  }
 
-  int cell_col = ROUNDY_DIGIT_START_COL;
-  for (int glyph_index = 0; glyph_index < ROUNDY_ANIMATED_GLYPH_COUNT;
-       ++glyph_index) {
-    prv_draw_glyph_slot(ctx, state, glyph_index, cell_col, cell_row,
-                        base_stroke);
-    switch (glyph_index) {
-      case 0:
-      case 1:
-      case 3:
-        cell_col += ROUNDY_DIGIT_WIDTH + ROUNDY_DIGIT_GAP;
-        break;
-      case 2:
-        cell_col += ROUNDY_DIGIT_COLON_WIDTH + ROUNDY_DIGIT_GAP;
-        break;
-      default:
-        break;
+  roundy_trace(RoundyTraceEventUpdateBegin, RoundyTraceLayerDigits);
+  const GColor base_stroke = roundy_palette_digit_stroke();
+  graphics_context_set_fill_color(ctx, roundy_palette_digit_fill());
+  graphics_context_set_compositing_mode(ctx, GCompOpAssign);
+  const uint32_t start_ms = roundy_render_stats_begin();
+  roundy_frame_governor_render_begin();
+  roundy_profile_frame_begin(RoundyProfileSectionDigits);
+
+  const uint8_t *cell = state->cells;
+  for (int row = 0; row < ROUNDY_GRID_ROWS; ++row) {
+    for (int col = 0; col < ROUNDY_GRID_COLS; ++col, ++cell) {
+      if (CELL_LIT(*cell)) {
+        prv_draw_cell(ctx, col, row, CELL_COLOR(*cell), *cell & CELL_STEP_MASK, base_stroke,
+                      state->atlas);
+      }
     }
   }
+  graphics_context_set_stroke_color(ctx, base_stroke);
+  roundy_profile_frame_end(RoundyProfileSectionDigits);
+  roundy_frame_governor_render_end();
+  roundy_render_stats_end(RoundyProfileSectionDigits, start_ms);
+  roundy_trace(RoundyTraceEventUpdateEnd, RoundyTraceLayerDigits);
 }
 
-RoundyDigitLayer *roundy_digit_layer_create(GRect frame) {
+/* Allocates the wrapper, its Layer and the state, all zeroed. */
+static RoundyDigitLayer *prv_alloc(GRect frame) {
+#if defined(ROUNDY_STATIC_ALLOC)
+  if (s_digit_layer_in_use) {
+    return NULL;
+  }
+
+  RoundyDigitLayer *layer = &s_digit_layer;
+  s_digit_state = (RoundyDigitLayerState){0};
+  if (layer->layer) {
+    layer_set_frame(layer->layer, frame);
+  } else {
+    layer->layer = layer_create_with_data(frame, sizeof(RoundyDigitLayerState *));
+    if (!layer->layer) {
+      return NULL;
+    }
+    *(RoundyDigitLayerState **)layer_get_data(layer->layer) = &s_digit_state;
+  }
+  s_digit_layer_in_use = true;
+#else
   RoundyDigitLayer *layer = calloc(1, sizeof(*layer));
   if (!layer) {
     return NULL;
@@ -387,21 +642,57 @@ RoundyDigitLayer *roundy_digit_layer_create(GRect frame) {
     free(layer);
     return NULL;
   }
+#endif
+  layer->state = prv_layer_state(layer->layer);
+  return layer;
+}
 
-  layer->state = layer_get_data(layer->layer);
-  layer->state->use_24h_time = clock_is_24h_style();
-  layer->state->anim_time = ROUNDY_GLYPH_DURATION;
-  layer->state->diag_mode_active = false;
-  layer->state->diag_time = (ROUNDY_ANIMATED_GLYPH_COUNT - 1) * ROUNDY_GLYPH_STAGGER + ROUNDY_GLYPH_DURATION;
-  for (int i = 0; i < ROUNDY_ANIMATED_GLYPH_COUNT; ++i) {
-    layer->state->glyph_active[i] = false;
-    layer->state->glyph_start[i] = 0.0f;
+/* Releases the wrapper and its Layer; the static ones are only detached. */
+static void prv_free(RoundyDigitLayer *layer) {
+#if defined(ROUNDY_STATIC_ALLOC)
+  layer_remove_from_parent(layer->layer);
+  s_digit_layer_in_use = false;
+#else
+  layer_destroy(layer->layer);
+  free(layer);
+#endif
+}
+
+static void prv_paint_atlas(RoundyCellAtlas *atlas) {
+  GColor colors[RoundyCellColorCount];
+  uint8_t levels[RoundyCellColorCount];
+  const int color_count = RoundyCellColorGradient + roundy_palette_gradient_steps();
+  for (int i = 0; i < color_count; ++i) {
+    colors[i] = prv_cell_color((RoundyCellColor)i);
+    levels[i] = prv_cell_level((RoundyCellColor)i);
   }
-  for (int i = 0; i < ROUNDY_DIGIT_COUNT; ++i) {
-    layer->state->digits[i] = -1;
-    layer->state->prev_digits[i] = -1;
+  roundy_cell_atlas_paint(atlas, roundy_palette_digit_fill(), colors, levels, color_count);
+}
+
+RoundyDigitLayer *roundy_digit_layer_create(GRect frame) {
+  RoundyDigitLayer *layer = prv_alloc(frame);
+  if (!layer) {
+    return NULL;
   }
 
+  layer->state->speed_percent = 100;
+  layer->state->anim = (RoundyDigitAnim){
+    .digits = UINT16_MAX,
+    .prev_digits = UINT16_MAX,
+    .time_ms = ROUNDY_GLYPH_DURATION_MS,
+    .diag_time_ms = ROUNDY_DIAG_TOTAL_MS,
+    .mode = RoundyDigitAnimGlyphs,
+    .use_24h_time = clock_is_24h_style(),
+  };
+#if defined(ROUNDY_PROFILE)
+  APP_LOG(APP_LOG_LEVEL_INFO, "memory: digit layer state %d bytes, %d of them animation",
+          (int)sizeof(RoundyDigitLayerState), (int)sizeof(RoundyDigitAnim));
+#endif
+
+  /* without the atlas cells are drawn pixel by pixel */
+  layer->state->atlas = roundy_cell_atlas_create();
+  prv_paint_atlas(layer->state->atlas);
+
   layer_set_update_proc(layer->layer, prv_digit_layer_update_proc);
   return layer;
 }
@@ -412,14 +703,22 @@ void roundy_digit_layer_destroy(RoundyDigitLayer *layer) {
   }
   if (layer->layer) {
     /* cancel any running animation timer stored in layer data */
-    RoundyDigitLayerState *state = layer_get_data(layer->layer);
+    RoundyDigitLayerState *state = prv_layer_state(layer->layer);
     if (state && state->anim_timer) {
+      roundy_trace(RoundyTraceEventTimerCancel, 0);
       app_timer_cancel(state->anim_timer);
       state->anim_timer = NULL;
     }
-    layer_destroy(layer->layer);
+    if (state) {
+      roundy_cell_atlas_destroy(state->atlas);
+      state->atlas = NULL;
+    }
   }
-  free(layer);
+  prv_free(layer);
+}
+
+size_t roundy_digit_layer_storage_size(void) {
+  return sizeof(RoundyDigitLayer) + sizeof(RoundyDigitLayerState);
 }
 
 Layer *roundy_digit_layer_get_layer(RoundyDigitLayer *layer) {
@@ -432,76 +731,84 @@ static void prv_diag_anim_timer(void *ctx) {
   if (!layer) {
     return;
   }
-  RoundyDigitLayerState *state = layer_get_data(layer);
+  RoundyDigitLayerState *state = prv_layer_state(layer);
   if (!state) {
     return;
   }
-  const int FRAME_MS = DIAG_FRAME_MS;
-  const int DURATION_MS = DIAG_DURATION_MS;
-  const float delta = (float)FRAME_MS / (float)DURATION_MS;
-
-  if (state->diag_mode_active) {
-    state->diag_time += delta;
-    const float diag_total = (ROUNDY_ANIMATED_GLYPH_COUNT - 1) * ROUNDY_GLYPH_STAGGER + ROUNDY_GLYPH_DURATION;
-    if (state->diag_time >= diag_total) {
-      state->diag_time = diag_total;
-      state->diag_mode_active = false;
-      state->anim_timer = NULL;
-    } else {
-      state->anim_timer =
-          app_timer_register(FRAME_MS, prv_diag_anim_timer, layer);
-    }
-    layer_mark_dirty(layer);
-    return;
-  }
-
-  state->anim_time += delta;
-  bool still_active = false;
-  for (int i = 0; i < ROUNDY_ANIMATED_GLYPH_COUNT; ++i) {
-    if (!state->glyph_active[i]) {
-      continue;
+  roundy_trace(RoundyTraceEventTimerFired, 0);
+  const int32_t frame_ms = (int32_t)roundy_frame_governor_frame();
+  const int32_t time_ms = prv_timeline_ms(state);
+
+  RoundyDigitAnim *anim = &state->anim;
+  /* progress saturates at the end, so clamping keeps the timeline in 16 bits */
+  const int16_t clamped_ms = (time_ms < anim->end_ms) ? (int16_t)time_ms : anim->end_ms;
+  if (anim->mode == RoundyDigitAnimDiag) {
+    anim->diag_time_ms = clamped_ms;
+    if (time_ms >= anim->end_ms) {
+      anim->mode = RoundyDigitAnimGlyphs;
     }
-    const float elapsed = state->anim_time - state->glyph_start[i];
-    if (elapsed >= ROUNDY_GLYPH_DURATION) {
-      state->glyph_active[i] = false;
-      continue;
+  } else {
+    anim->time_ms = clamped_ms;
+    for (int i = 0; i < ROUNDY_ANIMATED_GLYPH_COUNT; ++i) {
+      if (prv_glyph_active(anim, i) &&
+          time_ms - prv_glyph_start_ms(anim, i) >= ROUNDY_GLYPH_DURATION_MS) {
+        anim->glyph_active &= (uint8_t)~GLYPH_BIT(i);
+      }
     }
-    still_active = true;
   }
 
-  if (still_active) {
-    state->anim_timer = app_timer_register(FRAME_MS, prv_diag_anim_timer, layer);
+  if (time_ms < anim->end_ms) {
+    /* never overshoot the end, so the last frame lands on schedule */
+    const int32_t remaining_ms = prv_wall_ms(state, anim->end_ms - time_ms);
+    const int32_t delay_ms = (remaining_ms < frame_ms) ? remaining_ms : frame_ms;
+    roundy_trace(RoundyTraceEventTimerRegister, (uint32_t)delay_ms);
+    state->anim_timer = roundy_clock_timer_register(delay_ms, prv_diag_anim_timer, layer);
   } else {
     state->anim_timer = NULL;
+#if defined(ROUNDY_PROFILE)
+    RoundyFrameGovernorStats stats;
+    roundy_frame_governor_get_stats(&stats);
+    roundy_profile_animation(
+        (int32_t)anim->delay_ms + prv_wall_ms(state, anim->end_ms),
+        (int32_t)(roundy_clock_now_ms() - anim->requested_ms), &stats);
+#endif
+    roundy_profile_settled();
   }
 
-  layer_mark_dirty(layer);
+  prv_update_cells(layer, state);
 }
 
 void roundy_digit_layer_start_diag_flip(RoundyDigitLayer *rdl) {
   if (!rdl || !rdl->layer) {
     return;
   }
-  RoundyDigitLayerState *state = layer_get_data(rdl->layer);
+  RoundyDigitLayerState *state = prv_layer_state(rdl->layer);
   if (!state) {
     return;
   }
 
   if (state->anim_timer) {
+    roundy_trace(RoundyTraceEventTimerCancel, 0);
     app_timer_cancel(state->anim_timer);
     state->anim_timer = NULL;
   }
 
-  state->diag_mode_active = true;
-  state->diag_time = 0.0f;
-  state->anim_time = 0.0f;
-  for (int i = 0; i < ROUNDY_ANIMATED_GLYPH_COUNT; ++i) {
-    state->glyph_active[i] = false;
+  if (state->anim.instant) {
+    roundy_frame_governor_count_skipped(ROUNDY_FACE_INTRO_DELAY_MS +
+                                        (uint32_t)prv_wall_ms(state, ROUNDY_DIAG_TOTAL_MS));
+    prv_settle(state);
+    prv_update_cells(rdl->layer, state);
+    return;
   }
 
-  state->anim_timer =
-      app_timer_register(DIAG_START_DELAY_MS, prv_diag_anim_timer, rdl->layer);
-  layer_mark_dirty(rdl->layer);
+  state->anim.mode = RoundyDigitAnimDiag;
+  state->anim.diag_time_ms = 0;
+  state->anim.time_ms = 0;
+  state->anim.end_ms = ROUNDY_DIAG_TOTAL_MS;
+  state->anim.glyph_active = 0;
+
+  prv_start_timeline(rdl->layer, state, ROUNDY_FACE_INTRO_DELAY_MS);
+  prv_update_cells(rdl->layer, state);
 }
 
 void roundy_digit_layer_set_time(RoundyDigitLayer *layer, const struct tm *time_info) {
@@ -510,15 +817,16 @@ void roundy_digit_layer_set_time(RoundyDigitLayer *layer, const struct tm *time_
     return;
   }
 
+  roundy_trace(RoundyTraceEventSetTime, (uint32_t)time_info->tm_min);
   static const int glyph_index_map[ROUNDY_DIGIT_COUNT] = {0, 1, 3, 4};
   bool glyph_mask[ROUNDY_ANIMATED_GLYPH_COUNT] = {false};
 
-  int16_t old_digits[ROUNDY_DIGIT_COUNT];
-  for (int i = 0; i < ROUNDY_DIGIT_COUNT; ++i) {
-    old_digits[i] = state->digits[i];
-  }
+  RoundyDigitAnim *anim = &state->anim;
+  const uint16_t old_digits = anim->digits;
 
-  const bool use_24h = clock_is_24h_style();
+  const bool use_24h = (anim->clock_format == RoundyClockFormatSystem)
+                           ? clock_is_24h_style()
+                           : (anim->clock_format == RoundyClockFormat24h);
   int hour = time_info->tm_hour;
   if (!use_24h) {
     hour %= 12;
@@ -538,23 +846,22 @@ void roundy_digit_layer_set_time(RoundyDigitLayer *layer, const struct tm *time_
     new_digits[0] = -1;
   }
 
-  bool changed = (state->use_24h_time != use_24h);
+  bool changed = (anim->use_24h_time != use_24h);
   bool all_old_blank = true;
+  uint16_t digits = old_digits;
   for (int i = 0; i < ROUNDY_DIGIT_COUNT; ++i) {
-    if (state->digits[i] != new_digits[i]) {
+    if (prv_digit(old_digits, i) != new_digits[i]) {
       changed = true;
       glyph_mask[glyph_index_map[i]] = true;
     }
-    if (old_digits[i] >= 0) {
+    if (prv_digit(old_digits, i) >= 0) {
       all_old_blank = false;
     }
-    state->prev_digits[i] = old_digits[i];
-    state->digits[i] = new_digits[i];
-  }
-
-  if (state->use_24h_time != use_24h) {
-    state->use_24h_time = use_24h;
+    digits = prv_with_digit(digits, i, new_digits[i]);
   }
+  anim->prev_digits = old_digits;
+  anim->digits = digits;
+  anim->use_24h_time = use_24h;
 
   glyph_mask[2] = glyph_mask[1] || glyph_mask[3];
   bool any_glyph = false;
@@ -566,10 +873,10 @@ void roundy_digit_layer_set_time(RoundyDigitLayer *layer, const struct tm *time_
   }
 
   if (changed && layer->layer) {
-    if (any_glyph && !all_old_blank && !state->diag_mode_active) {
-      prv_start_glyph_animation(layer, glyph_mask, DIAG_FRAME_MS);
+    if (any_glyph && !all_old_blank && anim->mode != RoundyDigitAnimDiag) {
+      prv_start_glyph_animation(layer, glyph_mask, ROUNDY_FACE_MINUTE_DELAY_MS);
     }
-    layer_mark_dirty(layer->layer);
+    prv_update_cells(layer->layer, state);
   }
 }
 
@@ -584,6 +891,162 @@ void roundy_digit_layer_refresh_time(RoundyDigitLayer *layer) {
 
 void roundy_digit_layer_force_redraw(RoundyDigitLayer *layer) {
   if (layer && layer->layer) {
+    roundy_trace(RoundyTraceEventMarkDirty, RoundyTraceLayerDigits);
     layer_mark_dirty(layer->layer);
   }
+  RoundyDigitLayerState *state = prv_get_state(layer);
+  if (state && state->compositor) {
+    roundy_trace(RoundyTraceEventMarkDirty, RoundyTraceLayerCompositor);
+    layer_mark_dirty(state->compositor);
+  }
+}
+
+void roundy_digit_layer_refresh_palette(RoundyDigitLayer *layer) {
+  RoundyDigitLayerState *state = prv_get_state(layer);
+  if (!state) {
+    return;
+  }
+
+  prv_paint_atlas(state->atlas);
+  /* animating cells may sit on a step the new gradient does not have */
+  prv_compose_cells(state);
+  roundy_digit_layer_force_redraw(layer);
+}
+
+void roundy_digit_layer_set_compositor(RoundyDigitLayer *layer, Layer *compositor) {
+  RoundyDigitLayerState *state = prv_get_state(layer);
+  if (!state || state->compositor == compositor) {
+    return;
+  }
+
+  state->compositor = compositor;
+  roundy_digit_layer_force_redraw(layer);
+}
+
+int roundy_digit_layer_get_cell_row(RoundyDigitLayer *layer, int row,
+                                    RoundyDigitCell cells[ROUNDY_GRID_COLS]) {
+  RoundyDigitLayerState *state = prv_get_state(layer);
+  int lit = 0;
+  const uint8_t *cell = state ? &state->cells[row * ROUNDY_GRID_COLS] : NULL;
+  for (int col = 0; col < ROUNDY_GRID_COLS; ++col) {
+    if (!cell || !CELL_LIT(cell[col])) {
+      cells[col] = (RoundyDigitCell){.lit = false};
+      continue;
+    }
+
+    cells[col] = (RoundyDigitCell){
+      .lit = true,
+      .step = cell[col] & CELL_STEP_MASK,
+      .stroke = prv_cell_color(CELL_COLOR(cell[col])),
+      .level = prv_cell_level(CELL_COLOR(cell[col])),
+    };
+    ++lit;
+  }
+  return lit;
+}
+
+#define SNAPSHOT_VERSION 1
+
+/* What roundy_digit_layer_save_snapshot() persists. The grid fields tie the
+ * snapshot to the layout it was shown with. */
+typedef struct {
+  uint8_t version;
+  uint8_t grid_cols;
+  uint8_t grid_rows;
+  uint8_t digit_start_col;
+  uint8_t digit_start_row;
+  uint8_t use_24h_time;
+  uint16_t digits;
+} RoundyDigitSnapshot;
+
+static RoundyDigitSnapshot prv_snapshot_layout(void) {
+  return (RoundyDigitSnapshot){
+    .version = SNAPSHOT_VERSION,
+    .grid_cols = ROUNDY_GRID_COLS,
+    .grid_rows = ROUNDY_GRID_ROWS,
+    .digit_start_col = ROUNDY_DIGIT_START_COL,
+    .digit_start_row = ROUNDY_DIGIT_START_ROW,
+  };
+}
+
+bool roundy_digit_layer_save_snapshot(RoundyDigitLayer *layer) {
+  RoundyDigitLayerState *state = prv_get_state(layer);
+  if (!state) {
+    return false;
+  }
+
+  RoundyDigitSnapshot snapshot = prv_snapshot_layout();
+  snapshot.use_24h_time = state->anim.use_24h_time;
+  snapshot.digits = state->anim.digits;
+  return persist_write_data(ROUNDY_PERSIST_KEY_DIGIT_SNAPSHOT, &snapshot, sizeof(snapshot)) ==
+         (int)sizeof(snapshot);
+}
+
+bool roundy_digit_layer_restore_snapshot(RoundyDigitLayer *layer) {
+  RoundyDigitLayerState *state = prv_get_state(layer);
+  if (!state || !layer->layer) {
+    return false;
+  }
+
+  RoundyDigitSnapshot snapshot;
+  if (persist_read_data(ROUNDY_PERSIST_KEY_DIGIT_SNAPSHOT, &snapshot, sizeof(snapshot)) !=
+      (int)sizeof(snapshot)) {
+    return false;
+  }
+  const RoundyDigitSnapshot layout = prv_snapshot_layout();
+  if (snapshot.version != layout.version || snapshot.grid_cols != layout.grid_cols ||
+      snapshot.grid_rows != layout.grid_rows ||
+      snapshot.digit_start_col != layout.digit_start_col ||
+      snapshot.digit_start_row != layout.digit_start_row ||
+      !prv_digits_are_valid(snapshot.digits)) {
+    return false;
+  }
+
+  prv_settle(state);
+  state->anim.digits = snapshot.digits;
+  state->anim.prev_digits = snapshot.digits;
+  state->anim.use_24h_time = snapshot.use_24h_time;
+  prv_update_cells(layer->layer, state);
+  return true;
+}
+
+void roundy_digit_layer_set_clock_format(RoundyDigitLayer *layer, RoundyClockFormat format) {
+  RoundyDigitLayerState *state = prv_get_state(layer);
+  if (state) {
+    state->anim.clock_format = format;
+  }
+}
+
+void roundy_digit_layer_set_instant(RoundyDigitLayer *layer, bool instant) {
+  RoundyDigitLayerState *state = prv_get_state(layer);
+  if (!state || state->anim.instant == instant) {
+    return;
+  }
+
+  state->anim.instant = instant;
+  /* a running animation would keep the timer going, so finish it now */
+  if (instant && state->anim_timer && layer->layer) {
+    prv_settle(state);
+    prv_update_cells(layer->layer, state);
+  }
+}
+
+void roundy_digit_layer_set_speed(RoundyDigitLayer *layer, uint16_t percent) {
+  RoundyDigitLayerState *state = prv_get_state(layer);
+  if (!state || percent == 0) {
+    return;
+  }
+
+  /* the timeline scales all the time since epoch_ms, so a running animation
+   * would jump; move the epoch so that it carries on from where it is */
+  const int32_t timeline_ms = prv_timeline_ms(state);
+  state->speed_percent = percent;
+  if (state->anim_timer && timeline_ms > 0) {
+    state->anim.epoch_ms = roundy_clock_timeline_ms() - (uint32_t)prv_wall_ms(state, timeline_ms);
+  }
+}
+
+bool roundy_digit_layer_is_animating(RoundyDigitLayer *layer) {
+  RoundyDigitLayerState *state = prv_get_state(layer);
+  return state && state->anim_timer;
 }
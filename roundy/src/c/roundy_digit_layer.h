@@ -2,16 +2,76 @@
 
 #include <pebble.h>
 
+#include "roundy_layout.h"
+
 typedef struct RoundyDigitLayer RoundyDigitLayer;
 
+typedef enum {
+  /* follow clock_is_24h_style() */
+  RoundyClockFormatSystem = 0,
+  RoundyClockFormat12h,
+  RoundyClockFormat24h,
+} RoundyClockFormat;
+
+/* A digit cell as shown in the current frame. */
+typedef struct {
+  bool lit;
+  /* diagonal step, see roundy_cell_step() */
+  uint8_t step;
+  GColor stroke;
+  /* grey level of the stroke; black and white platforms draw the stroke
+   * white through roundy_dither_rows() of it instead of in `stroke` */
+  uint8_t level;
+} RoundyDigitCell;
+
 RoundyDigitLayer *roundy_digit_layer_create(GRect frame);
 void roundy_digit_layer_destroy(RoundyDigitLayer *layer);
 Layer *roundy_digit_layer_get_layer(RoundyDigitLayer *layer);
+/* Bytes of wrapper and state behind one digit layer; in static storage when
+ * built with ROUNDY_STATIC_ALLOC, on the heap otherwise. */
+size_t roundy_digit_layer_storage_size(void);
 void roundy_digit_layer_set_time(RoundyDigitLayer *layer, const struct tm *time);
 void roundy_digit_layer_refresh_time(RoundyDigitLayer *layer);
 void roundy_digit_layer_force_redraw(RoundyDigitLayer *layer);
+/* Redraws the cell sprites after roundy_palette_set_theme() and marks the
+ * layers dirty once; nothing is reallocated. */
+void roundy_digit_layer_refresh_palette(RoundyDigitLayer *layer);
+/* Takes effect on the next roundy_digit_layer_set_time(). */
+void roundy_digit_layer_set_clock_format(RoundyDigitLayer *layer, RoundyClockFormat format);
+/* When instant, new digits and the intro are shown settled right away, and a
+ * running animation is cut short. */
+void roundy_digit_layer_set_instant(RoundyDigitLayer *layer, bool instant);
+/* Plays the animations at `percent` of their own speed; 100 by default.
+ * Takes effect on the next animation frame. */
+void roundy_digit_layer_set_speed(RoundyDigitLayer *layer, uint16_t percent);
+bool roundy_digit_layer_is_animating(RoundyDigitLayer *layer);
 /**
  * Start a short diagonal flip animation when the watchface appears.
  * The animation quickly flips the cell diagonals to the opposite angle.
  */
 void roundy_digit_layer_start_diag_flip(RoundyDigitLayer *layer);
+/**
+ * Hand drawing over to `compositor`, which then gets marked dirty whenever the
+ * digits change and reads them with roundy_digit_layer_get_cell_row(). The
+ * digit layer itself stops drawing. Pass NULL to draw the digits again.
+ */
+void roundy_digit_layer_set_compositor(RoundyDigitLayer *layer, Layer *compositor);
+/**
+ * Fill `cells` with grid row `row` of the current frame and return the number
+ * of lit cells in it.
+ */
+int roundy_digit_layer_get_cell_row(RoundyDigitLayer *layer, int row,
+                                    RoundyDigitCell cells[ROUNDY_GRID_COLS]);
+/**
+ * Persist the digits currently shown, so the next launch can show them
+ * settled before its first frame. Returns false if nothing was written.
+ */
+bool roundy_digit_layer_save_snapshot(RoundyDigitLayer *layer);
+/**
+ * Show the persisted digits settled, without animating. Returns false when
+ * there is no snapshot, it was taken with a different grid layout or it
+ * holds a digit that is neither 0-9 nor blank; a
+ * following roundy_digit_layer_set_time() animates only the digits that
+ * changed since.
+ */
+bool roundy_digit_layer_restore_snapshot(RoundyDigitLayer *layer);
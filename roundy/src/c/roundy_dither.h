@@ -0,0 +1,32 @@
+#pragma once
+
+#include <pebble.h>
+
+#include "roundy_layout.h"
+
+/* Ordered dithering for the black and white displays, where every grey step
+ * of a flip's gradient would otherwise come out black. A cell's stroke is a
+ * single pixel per row, so a grey level keeps that share of the rows lit and
+ * leaves the fill showing in the others. Rows light up in the order
+ * 0, 2, 4, 1, 3, 5, which keeps the lit pixels spread along the diagonal at
+ * every level. */
+
+#define ROUNDY_DITHER_LEVELS 16
+
+_Static_assert(ROUNDY_CELL_SIZE == 6, "the dither rows are laid out for 6 px cells");
+
+/* Bit `idx` is set where cell row `idx` of a stroke at grey `level`, from 0
+ * (black) to ROUNDY_DITHER_LEVELS (white), is lit. */
+static inline uint8_t roundy_dither_rows(int level) {
+  static const uint8_t s_rows[ROUNDY_DITHER_LEVELS + 1] = {
+    0x00, 0x00, 0x01, 0x01, 0x01, 0x05, 0x05, 0x15, 0x15,
+    0x15, 0x17, 0x17, 0x17, 0x1F, 0x1F, 0x3F, 0x3F,
+  };
+  return s_rows[level];
+}
+
+/* Grey level of a colour, for the colours the palette resolves to. */
+static inline uint8_t roundy_dither_level(uint8_t r, uint8_t g, uint8_t b) {
+  const int luma = ((r * 2) + (g * 5) + b) / 8;
+  return (uint8_t)(((luma * ROUNDY_DITHER_LEVELS) + 127) / 255);
+}
@@ -0,0 +1,101 @@
+#include "roundy_frame_dump.h"
+
+#if defined(ROUNDY_FRAME_DUMP)
+
+#include <stdio.h>
+
+/* bytes per "dump,row" line, APP_LOG truncates long messages */
+#define DUMP_CHUNK_BYTES 48
+#define DUMP_LABEL_LENGTH 24
+
+static char s_label[DUMP_LABEL_LENGTH];
+static uint16_t s_frame_index;
+
+void roundy_frame_dump_set_label(const char *label) {
+  if (!label) {
+    s_label[0] = '\0';
+  } else if (strncmp(s_label, label, sizeof(s_label)) != 0) {
+    strncpy(s_label, label, sizeof(s_label) - 1);
+    s_label[sizeof(s_label) - 1] = '\0';
+    s_frame_index = 0;
+  }
+}
+
+/* bitwise CRC-32 (IEEE), slow but table free; only debug builds use it */
+static uint32_t prv_crc32(uint32_t crc, const uint8_t *data, size_t length) {
+  crc = ~crc;
+  for (size_t i = 0; i < length; ++i) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (uint32_t)-(int32_t)(crc & 1));
+    }
+  }
+  return ~crc;
+}
+
+static void prv_log_row(int y, int x, const uint8_t *data, size_t length, int bits_per_pixel) {
+  static const char hex[] = "0123456789abcdef";
+  char text[(DUMP_CHUNK_BYTES * 2) + 1];
+  for (size_t offset = 0; offset < length; offset += DUMP_CHUNK_BYTES) {
+    const size_t chunk = (length - offset < DUMP_CHUNK_BYTES) ? length - offset
+                                                              : DUMP_CHUNK_BYTES;
+    for (size_t i = 0; i < chunk; ++i) {
+      text[i * 2] = hex[data[offset + i] >> 4];
+      text[(i * 2) + 1] = hex[data[offset + i] & 0x0F];
+    }
+    text[chunk * 2] = '\0';
+    APP_LOG(APP_LOG_LEVEL_INFO, "dump,row,%s,%d,%d,%d,%s", s_label, (int)s_frame_index, y,
+            x + (int)((offset * 8) / bits_per_pixel), text);
+  }
+}
+
+static void prv_dump_update_proc(Layer *layer, GContext *ctx) {
+  (void)layer;
+  if (!s_label[0]) {
+    return;
+  }
+
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) {
+    return;
+  }
+
+  const GRect bounds = gbitmap_get_bounds(fb);
+  const int bits_per_pixel = (gbitmap_get_format(fb) == GBitmapFormat1Bit) ? 1 : 8;
+  uint32_t crc = 0;
+  for (int y = 0; y < bounds.size.h; ++y) {
+#if defined(PBL_ROUND)
+    /* chalk rows only hold the visible span of the circular display */
+    const GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, y);
+    crc = prv_crc32(crc, info.data + info.min_x, info.max_x - info.min_x + 1);
+#else
+    const uint8_t *row = gbitmap_get_data(fb) + (y * gbitmap_get_bytes_per_row(fb));
+    crc = prv_crc32(crc, row, ((bounds.size.w * bits_per_pixel) + 7) / 8);
+#endif
+  }
+  APP_LOG(APP_LOG_LEVEL_INFO, "dump,frame,%s,%d,%d,%d,%d,%08lx", s_label, (int)s_frame_index,
+          bounds.size.w, bounds.size.h, bits_per_pixel, (unsigned long)crc);
+
+  for (int y = 0; y < bounds.size.h; ++y) {
+#if defined(PBL_ROUND)
+    const GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, y);
+    prv_log_row(y, info.min_x, info.data + info.min_x, info.max_x - info.min_x + 1,
+                bits_per_pixel);
+#else
+    const uint8_t *row = gbitmap_get_data(fb) + (y * gbitmap_get_bytes_per_row(fb));
+    prv_log_row(y, 0, row, ((bounds.size.w * bits_per_pixel) + 7) / 8, bits_per_pixel);
+#endif
+  }
+  graphics_release_frame_buffer(ctx, fb);
+  s_frame_index++;
+}
+
+Layer *roundy_frame_dump_layer_create(GRect frame) {
+  Layer *layer = layer_create(frame);
+  if (layer) {
+    layer_set_update_proc(layer, prv_dump_update_proc);
+  }
+  return layer;
+}
+
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <pebble.h>
+
+/* Golden-frame dumps for pixel-exact regression checks. Build with
+ * ROUNDY_FRAME_DUMP=1 in the environment (see wscript); this also enables the
+ * replay mode, which plays the intro flip and a handful of minute transitions
+ * on its virtual clock. While a label is set, every rendered frame is logged
+ * as a CRC line followed by its rows in hex:
+ *
+ *   dump,frame,<label>,<index>,<width>,<height>,<bits per pixel>,<crc32>
+ *   dump,row,<label>,<index>,<y>,<x>,<hex pixels>
+ *
+ * tools/roundy_frames.py turns the log into images and diffs them against
+ * the golden frames. Without ROUNDY_FRAME_DUMP every hook compiles to nothing.
+ */
+
+#if defined(ROUNDY_FRAME_DUMP)
+
+/* A layer to put on top of everything else; it draws nothing and dumps the
+ * framebuffer the layers below have rendered. */
+Layer *roundy_frame_dump_layer_create(GRect frame);
+/* Names the frames that follow, NULL stops dumping. */
+void roundy_frame_dump_set_label(const char *label);
+
+#else
+
+#define roundy_frame_dump_set_label(label) ((void)0)
+
+#endif
@@ -0,0 +1,134 @@
+#include "roundy_frame_governor.h"
+
+#include "roundy_clock.h"
+
+/* shortest frame interval per platform; aplite cannot push a full frame over
+ * its display bus in 16 ms and emery has the most pixels to move */
+#if defined(PBL_PLATFORM_APLITE)
+#define GOVERNOR_MIN_FRAME_MS 33
+#elif defined(PBL_PLATFORM_EMERY)
+#define GOVERNOR_MIN_FRAME_MS 20
+#else
+#define GOVERNOR_MIN_FRAME_MS 16
+#endif
+/* below 10 fps the flip no longer reads as motion, so stop backing off */
+#define GOVERNOR_MAX_FRAME_MS 100
+/* the render cost is averaged in 1/16 ms over roughly the last four frames */
+#define GOVERNOR_COST_SHIFT 4
+#define GOVERNOR_SMOOTHING_SHIFT 2
+
+typedef struct {
+  bool fixed;
+  uint8_t budget;
+  uint16_t frame_ms;
+  /* set with roundy_frame_governor_set_min_interval(), 0 if unset */
+  uint16_t floor_ms;
+  /* animation time that ran below the full frame rate or not at all */
+  uint32_t avoided_ms;
+  /* cost of the frame being rendered since the last tick */
+  uint32_t render_start_ms;
+  uint32_t frame_cost_ms;
+  bool rendered;
+  /* smoothed cost per frame in 1/16 ms */
+  int32_t avg_cost;
+  uint32_t last_tick_ms;
+  uint16_t frames;
+  uint16_t dropped;
+} RoundyFrameGovernor;
+
+static RoundyFrameGovernor s_governor = {
+  .budget = ROUNDY_FRAME_GOVERNOR_DEFAULT_BUDGET,
+  .frame_ms = GOVERNOR_MIN_FRAME_MS,
+};
+
+void roundy_frame_governor_reset(void) {
+  /* the smoothed cost carries over, it describes the platform more than the
+   * animation */
+  s_governor.frames = 0;
+  s_governor.dropped = 0;
+  s_governor.frame_cost_ms = 0;
+  s_governor.rendered = false;
+}
+
+void roundy_frame_governor_set_budget(uint8_t percent) {
+  s_governor.budget = (percent == 0) ? 1 : (percent > 100) ? 100 : percent;
+}
+
+void roundy_frame_governor_set_adaptive(bool adaptive) {
+  s_governor.fixed = !adaptive;
+}
+
+void roundy_frame_governor_set_min_interval(uint16_t frame_ms) {
+  s_governor.floor_ms = frame_ms;
+}
+
+void roundy_frame_governor_render_begin(void) {
+  s_governor.render_start_ms = roundy_clock_now_ms();
+}
+
+void roundy_frame_governor_render_end(void) {
+  s_governor.frame_cost_ms += roundy_clock_now_ms() - s_governor.render_start_ms;
+  s_governor.rendered = true;
+}
+
+uint32_t roundy_frame_governor_frame(void) {
+  RoundyFrameGovernor *governor = &s_governor;
+  const uint32_t now_ms = roundy_clock_now_ms();
+
+  if (governor->rendered) {
+    const int32_t cost = (int32_t)governor->frame_cost_ms << GOVERNOR_COST_SHIFT;
+    governor->avg_cost += (cost - governor->avg_cost) >> GOVERNOR_SMOOTHING_SHIFT;
+    governor->frame_cost_ms = 0;
+    governor->rendered = false;
+  }
+
+  /* a tick that arrives whole intervals late stands for the frames it
+   * skipped */
+  if (governor->frames > 0) {
+    const uint32_t late_ms = now_ms - governor->last_tick_ms;
+    if (late_ms >= 2u * governor->frame_ms) {
+      governor->dropped += (late_ms / governor->frame_ms) - 1;
+    }
+  }
+  governor->last_tick_ms = now_ms;
+  governor->frames++;
+
+  /* the interval in which the smoothed cost takes `budget` percent */
+  uint32_t frame_ms = ((((uint32_t)governor->avg_cost * 100) / governor->budget) +
+                       (1 << GOVERNOR_COST_SHIFT) - 1) >> GOVERNOR_COST_SHIFT;
+  if (governor->fixed || frame_ms < GOVERNOR_MIN_FRAME_MS) {
+    frame_ms = GOVERNOR_MIN_FRAME_MS;
+  } else if (frame_ms > GOVERNOR_MAX_FRAME_MS) {
+    frame_ms = GOVERNOR_MAX_FRAME_MS;
+  }
+  if (frame_ms < governor->floor_ms) {
+    governor->avoided_ms += governor->floor_ms - frame_ms;
+    frame_ms = governor->floor_ms;
+  }
+  governor->frame_ms = (uint16_t)frame_ms;
+  return frame_ms;
+}
+
+void roundy_frame_governor_get_stats(RoundyFrameGovernorStats *stats) {
+  if (!stats) {
+    return;
+  }
+
+  *stats = (RoundyFrameGovernorStats){
+    .frame_ms = s_governor.frame_ms,
+    .render_ms = (uint16_t)((s_governor.avg_cost + (1 << GOVERNOR_COST_SHIFT) - 1) >>
+                            GOVERNOR_COST_SHIFT),
+    .frames = s_governor.frames,
+    .dropped = s_governor.dropped,
+  };
+}
+
+void roundy_frame_governor_count_skipped(uint32_t duration_ms) {
+  s_governor.avoided_ms += duration_ms;
+}
+
+uint32_t roundy_frame_governor_take_avoided(void) {
+  const uint32_t frames = s_governor.avoided_ms / GOVERNOR_MIN_FRAME_MS;
+  s_governor.avoided_ms -= frames * GOVERNOR_MIN_FRAME_MS;
+  return frames;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <pebble.h>
+
+/* Paces animation frames to the measured render cost. Every update_proc
+ * reports how long it took; the governor picks the frame interval that keeps
+ * rendering within a share of the CPU (the budget) and never below the
+ * platform's minimum interval, so slow platforms and busy moments get a
+ * lower frame rate instead of a backlog of late timers. */
+
+/* default share of each frame interval that rendering may take, in percent */
+#define ROUNDY_FRAME_GOVERNOR_DEFAULT_BUDGET 50
+
+typedef struct {
+  /* interval the next frame is scheduled with */
+  uint16_t frame_ms;
+  /* smoothed render cost of one frame */
+  uint16_t render_ms;
+  /* frames since the last reset and frames skipped because a tick came late */
+  uint16_t frames;
+  uint16_t dropped;
+} RoundyFrameGovernorStats;
+
+/* Start counting frames for a new animation. */
+void roundy_frame_governor_reset(void);
+void roundy_frame_governor_set_budget(uint8_t percent);
+/* When not adaptive every frame uses the platform's minimum interval, which
+ * keeps frame counts reproducible. */
+void roundy_frame_governor_set_adaptive(bool adaptive);
+/* Never schedule frames closer than `frame_ms`; 0 restores the platform's
+ * minimum interval. Used to trade smoothness for fewer wakeups. */
+void roundy_frame_governor_set_min_interval(uint16_t frame_ms);
+
+/* Bracket an update_proc; all calls between two frames add up to the cost
+ * of that frame. */
+void roundy_frame_governor_render_begin(void);
+void roundy_frame_governor_render_end(void);
+
+/* Call on every animation tick before composing. Returns the interval to
+ * schedule the next tick with. */
+uint32_t roundy_frame_governor_frame(void);
+
+void roundy_frame_governor_get_stats(RoundyFrameGovernorStats *stats);
+
+/* Record an animation of `duration_ms` that was not run at all. */
+void roundy_frame_governor_count_skipped(uint32_t duration_ms);
+/* Frames not rendered because of the minimum interval or skipped
+ * animations since the last call, counted at the platform's full frame
+ * rate. */
+uint32_t roundy_frame_governor_take_avoided(void);
@@ -1,48 +0,0 @@
-#include "roundy_glyphs.h"
-
-const RoundyGlyph ROUNDY_GLYPHS[ROUNDY_GLYPH_COUNT] = {
-  { // 0
-    .width = ROUNDY_DIGIT_WIDTH,
-    .rows = {0x0F, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x0F},
-  },
-  { // 1
-    .width = ROUNDY_DIGIT_WIDTH,
-    .rows = {0x02, 0x02, 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0F},
-  },
-  { // 2
-    .width = ROUNDY_DIGIT_WIDTH,
-    .rows = {0x0F, 0x01, 0x01, 0x01, 0x0F, 0x08, 0x08, 0x08, 0x0F},
-  },
-  { // 3
-    .width = ROUNDY_DIGIT_WIDTH,
-    .rows = {0x0F, 0x01, 0x01, 0x01, 0x0F, 0x01, 0x01, 0x01, 0x0F},
-  },
-  { // 4
-    .width = ROUNDY_DIGIT_WIDTH,
-    .rows = {0x09, 0x09, 0x09, 0x09, 0x0F, 0x01, 0x01, 0x01, 0x01},
-  },
-  { // 5
-    .width = ROUNDY_DIGIT_WIDTH,
-    .rows = {0x0F, 0x08, 0x08, 0x08, 0x0F, 0x01, 0x01, 0x01, 0x0F},
-  },
-  { // 6
-    .width = ROUNDY_DIGIT_WIDTH,
-    .rows = {0x0F, 0x08, 0x08, 0x08, 0x0F, 0x09, 0x09, 0x09, 0x0F},
-  },
-  { // 7
-    .width = ROUNDY_DIGIT_WIDTH,
-    .rows = {0x0F, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01},
-  },
-  { // 8
-    .width = ROUNDY_DIGIT_WIDTH,
-    .rows = {0x0F, 0x09, 0x09, 0x09, 0x0F, 0x09, 0x09, 0x09, 0x0F},
-  },
-  { // 9
-    .width = ROUNDY_DIGIT_WIDTH,
-    .rows = {0x0F, 0x09, 0x09, 0x09, 0x0F, 0x01, 0x01, 0x01, 0x0F},
-  },
-  { // colon
-    .width = ROUNDY_DIGIT_COLON_WIDTH,
-    .rows = {0x00, 0x00, 0x03, 0x03, 0x00, 0x03, 0x03, 0x00, 0x00},
-  },
-};
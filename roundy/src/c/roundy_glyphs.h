@@ -4,11 +4,45 @@
 
 #include "roundy_layout.h"
 
+/* Glyph cells packed into a 64-bit bitboard, ROUNDY_GLYPH_STRIDE bits per
+ * row. Every glyph shares the same stride so cell sets of different glyphs
+ * can be combined with plain bitwise operations. */
+#define ROUNDY_GLYPH_STRIDE ROUNDY_DIGIT_WIDTH
+
+typedef uint64_t RoundyBitboard;
+
+_Static_assert(ROUNDY_GLYPH_STRIDE * ROUNDY_DIGIT_HEIGHT <= 64,
+               "glyph cells must fit in a RoundyBitboard");
+
 typedef struct {
   uint8_t width;
-  uint8_t rows[ROUNDY_DIGIT_HEIGHT];
+  RoundyBitboard cells;
 } RoundyGlyph;
 
+/* Number of diagonals (row + col) a glyph of the widest stride spans. */
+#define ROUNDY_GLYPH_DIAG_COUNT (ROUNDY_GLYPH_STRIDE + ROUNDY_DIGIT_HEIGHT - 1)
+
+typedef struct {
+  uint8_t row : 4;
+  uint8_t col : 4;
+} RoundyGlyphCell;
+
+/* Lit cells of a glyph in ROUNDY_GLYPH_CELLS, sorted by diagonal. The cells on
+ * diagonal d are first_cell + [diag_start[d], diag_start[d + 1]); entries past
+ * the glyph's own last diagonal are unused. */
+typedef struct {
+  uint16_t first_cell;
+  uint8_t diag_start[ROUNDY_GLYPH_DIAG_COUNT + 1];
+} RoundyGlyphSpans;
+
+/* Cells an (old, new) glyph change removes, adds and keeps. Only removed and
+ * added cells need to animate. */
+typedef struct {
+  RoundyBitboard removed;
+  RoundyBitboard added;
+  RoundyBitboard kept;
+} RoundyGlyphTransition;
+
 enum {
   ROUNDY_GLYPH_ZERO = 0,
   ROUNDY_GLYPH_ONE,
@@ -24,4 +58,29 @@ enum {
   ROUNDY_GLYPH_COUNT
 };
 
+/* Generated at build time from src/glyphs/roundy_glyphs.txt by
+ * tools/roundy_glyphgen.py. */
 extern const RoundyGlyph ROUNDY_GLYPHS[ROUNDY_GLYPH_COUNT];
+extern const RoundyGlyphCell ROUNDY_GLYPH_CELLS[];
+extern const RoundyGlyphSpans ROUNDY_GLYPH_SPANS[ROUNDY_GLYPH_COUNT];
+
+static inline RoundyBitboard roundy_glyph_cell_bit(int row, int col) {
+  return (RoundyBitboard)1 << ((row * ROUNDY_GLYPH_STRIDE) + (ROUNDY_GLYPH_STRIDE - 1 - col));
+}
+
+/* cells of `glyph`, or none for a blank (out of range) glyph */
+static inline RoundyBitboard roundy_glyph_cells(int glyph) {
+  return (glyph >= 0 && glyph < ROUNDY_GLYPH_COUNT) ? ROUNDY_GLYPHS[glyph].cells : 0;
+}
+
+static inline RoundyGlyphTransition roundy_glyph_plan_transition(int old_glyph,
+                                                                 int new_glyph) {
+  const RoundyBitboard old_cells = roundy_glyph_cells(old_glyph);
+  const RoundyBitboard new_cells = roundy_glyph_cells(new_glyph);
+  const RoundyBitboard changed = old_cells ^ new_cells;
+  return (RoundyGlyphTransition){
+    .removed = changed & old_cells,
+    .added = changed & new_cells,
+    .kept = old_cells & new_cells,
+  };
+}
@@ -0,0 +1,60 @@
+#include "roundy_layout.h"
+
+#if defined(PBL_ROUND)
+
+/* Distances are in half pixels so the circle and the pixel centres land on
+ * whole numbers. A cell counts as visible when its pixel nearest to the
+ * centre lies within a circle one pixel wider than the display, which
+ * errs towards drawing a cell the display's own edge mask clips. */
+#define LAYOUT_CENTER_X PBL_DISPLAY_WIDTH
+#define LAYOUT_CENTER_Y PBL_DISPLAY_HEIGHT
+#define LAYOUT_RADIUS (PBL_DISPLAY_WIDTH + 2)
+
+static RoundyCellSpan s_spans[ROUNDY_GRID_ROWS];
+static bool s_spans_valid;
+
+/* Half-pixel distance from `center` to the nearest pixel centre of the cell
+ * starting at `cell_start`. */
+static int prv_nearest_distance(int cell_start, int center) {
+  const int first = (2 * cell_start) + 1;
+  const int last = (2 * (cell_start + ROUNDY_CELL_SIZE - 1)) + 1;
+  if (center < first) {
+    return first - center;
+  }
+  return (center > last) ? center - last : 0;
+}
+
+static bool prv_cell_visible(int cell_col, int cell_row) {
+  const int dx = prv_nearest_distance(cell_col * ROUNDY_CELL_SIZE, LAYOUT_CENTER_X);
+  const int dy = prv_nearest_distance(cell_row * ROUNDY_CELL_SIZE, LAYOUT_CENTER_Y);
+  return (dx * dx) + (dy * dy) <= LAYOUT_RADIUS * LAYOUT_RADIUS;
+}
+
+static void prv_compute_spans(void) {
+  for (int row = 0; row < ROUNDY_GRID_ROWS; ++row) {
+    /* every row crosses the vertical centre line, and the circle is convex,
+     * so the visible cells are one contiguous run */
+    int first = 0;
+    while (first < ROUNDY_GRID_COLS && !prv_cell_visible(first, row)) {
+      ++first;
+    }
+    int end = ROUNDY_GRID_COLS;
+    while (end > first && !prv_cell_visible(end - 1, row)) {
+      --end;
+    }
+    s_spans[row] = (RoundyCellSpan){.first_col = (uint8_t)first, .end_col = (uint8_t)end};
+  }
+  s_spans_valid = true;
+}
+
+RoundyCellSpan roundy_layout_row_span(int cell_row) {
+  if (cell_row < 0 || cell_row >= ROUNDY_GRID_ROWS) {
+    return (RoundyCellSpan){0};
+  }
+  if (!s_spans_valid) {
+    prv_compute_spans();
+  }
+  return s_spans[cell_row];
+}
+
+#endif
@@ -2,19 +2,30 @@
 
 #include <pebble.h>
 
+/* The grid is derived from the display size at compile time: as many whole
+ * cells as fit, anchored at the top left. Any remainder narrower than one
+ * cell on the right or bottom edge is plain background fill. The digits are
+ * centred on the grid, which puts them where they always were on the
+ * 144x168 displays. */
 enum {
-  ROUNDY_GRID_COLS = 24,
-  ROUNDY_GRID_ROWS = 28,
   ROUNDY_CELL_SIZE = 6,
+  ROUNDY_GRID_COLS = PBL_DISPLAY_WIDTH / ROUNDY_CELL_SIZE,
+  ROUNDY_GRID_ROWS = PBL_DISPLAY_HEIGHT / ROUNDY_CELL_SIZE,
   ROUNDY_DIGIT_WIDTH = 4,
   ROUNDY_DIGIT_HEIGHT = 9,
   ROUNDY_DIGIT_COLON_WIDTH = 2,
   ROUNDY_DIGIT_COUNT = 4,
   ROUNDY_DIGIT_GAP = 1,
-  ROUNDY_DIGIT_START_COL = 1,
-  ROUNDY_DIGIT_START_ROW = 10,
+  /* four digits and the colon with a gap between each */
+  ROUNDY_DIGIT_BLOCK_WIDTH = (ROUNDY_DIGIT_COUNT * ROUNDY_DIGIT_WIDTH) +
+                             ROUNDY_DIGIT_COLON_WIDTH + (ROUNDY_DIGIT_COUNT * ROUNDY_DIGIT_GAP),
+  ROUNDY_DIGIT_START_COL = (ROUNDY_GRID_COLS - ROUNDY_DIGIT_BLOCK_WIDTH) / 2,
+  ROUNDY_DIGIT_START_ROW = (ROUNDY_GRID_ROWS - ROUNDY_DIGIT_HEIGHT + 1) / 2,
 };
 
+_Static_assert(ROUNDY_DIGIT_START_COL >= 0 && ROUNDY_DIGIT_START_ROW >= 0,
+               "the digits do not fit the display");
+
 static inline GPoint roundy_cell_origin(int cell_col, int cell_row) {
   return GPoint(cell_col * ROUNDY_CELL_SIZE, cell_row * ROUNDY_CELL_SIZE);
 }
@@ -23,3 +34,20 @@ static inline GRect roundy_cell_frame(int cell_col, int cell_row) {
   return GRect(cell_col * ROUNDY_CELL_SIZE, cell_row * ROUNDY_CELL_SIZE,
                ROUNDY_CELL_SIZE, ROUNDY_CELL_SIZE);
 }
+
+/* Grid columns [first_col, end_col) of one row that can show on screen. */
+typedef struct {
+  uint8_t first_col;
+  uint8_t end_col;
+} RoundyCellSpan;
+
+#if defined(PBL_ROUND)
+/* Cells outside the circular display are never visible; the spans are
+ * computed once, on first use. */
+RoundyCellSpan roundy_layout_row_span(int cell_row);
+#else
+static inline RoundyCellSpan roundy_layout_row_span(int cell_row) {
+  (void)cell_row;
+  return (RoundyCellSpan){.first_col = 0, .end_col = ROUNDY_GRID_COLS};
+}
+#endif
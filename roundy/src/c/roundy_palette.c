@@ -0,0 +1,96 @@
+#include "roundy_palette.h"
+
+#include "roundy_dither.h"
+
+typedef struct {
+  /* 0xRRGGBB ends of the gradient, interpolated per channel */
+  uint32_t from;
+  uint32_t to;
+  uint8_t steps;
+} RoundyPaletteThemeSpec;
+
+static const RoundyPaletteThemeSpec s_themes[RoundyPaletteThemeCount] = {
+  [RoundyPaletteThemeMono] = {.from = 0x555555, .to = 0xFFFFFF, .steps = 3},
+  [RoundyPaletteThemeEmber] = {.from = 0xAA0000, .to = 0xFFFF00, .steps = 4},
+  [RoundyPaletteThemeOcean] = {.from = 0x0000AA, .to = 0x00FFFF, .steps = 4},
+};
+
+typedef struct {
+  RoundyPaletteTheme theme;
+  uint8_t steps;
+  bool ready;
+  GColor8 gradient[ROUNDY_PALETTE_MAX_STEPS];
+  uint8_t levels[ROUNDY_PALETTE_MAX_STEPS];
+} RoundyPaletteTable;
+
+static RoundyPaletteTable s_table;
+
+static uint8_t prv_channel(uint32_t from, uint32_t to, int shift, int step, int last) {
+  const int a = (int)((from >> shift) & 0xFF);
+  const int b = (int)((to >> shift) & 0xFF);
+  return (uint8_t)((last == 0) ? b : a + (((b - a) * step) / last));
+}
+
+static GColor prv_resolve(uint8_t r, uint8_t g, uint8_t b) {
+#if defined(PBL_COLOR)
+  return GColorFromRGB(r, g, b);
+#else
+  /* only the brightest colours survive on black and white */
+  const int luma = ((r * 2) + (g * 5) + b) / 8;
+  return (luma >= 0xC0) ? GColorWhite : GColorBlack;
+#endif
+}
+
+static void prv_build_table(RoundyPaletteTheme theme) {
+  const RoundyPaletteThemeSpec *spec = &s_themes[theme];
+  const int last = spec->steps - 1;
+  s_table.theme = theme;
+  s_table.steps = spec->steps;
+  for (int step = 0; step < spec->steps; ++step) {
+    const uint8_t r = prv_channel(spec->from, spec->to, 16, step, last);
+    const uint8_t g = prv_channel(spec->from, spec->to, 8, step, last);
+    const uint8_t b = prv_channel(spec->from, spec->to, 0, step, last);
+    s_table.gradient[step] = prv_resolve(r, g, b);
+    s_table.levels[step] = roundy_dither_level(r, g, b);
+  }
+  s_table.ready = true;
+}
+
+static inline const RoundyPaletteTable *prv_table(void) {
+  if (!s_table.ready) {
+    prv_build_table(RoundyPaletteThemeMono);
+  }
+  return &s_table;
+}
+
+void roundy_palette_set_theme(RoundyPaletteTheme theme) {
+  if (theme >= RoundyPaletteThemeCount) {
+    theme = RoundyPaletteThemeMono;
+  }
+  if (!s_table.ready || s_table.theme != theme) {
+    prv_build_table(theme);
+  }
+}
+
+RoundyPaletteTheme roundy_palette_get_theme(void) {
+  return prv_table()->theme;
+}
+
+int roundy_palette_gradient_steps(void) {
+  return prv_table()->steps;
+}
+
+int roundy_palette_gradient_step(RoundyProgress progress) {
+  const int steps = prv_table()->steps;
+  /* equal slices of the flip; progress * 3 < 1 is the first of three */
+  const int step = (int)((progress * steps) >> ROUNDY_PROGRESS_SHIFT);
+  return (step < steps) ? step : steps - 1;
+}
+
+GColor roundy_palette_gradient_color(int step) {
+  return prv_table()->gradient[step];
+}
+
+uint8_t roundy_palette_gradient_level(int step) {
+  return prv_table()->levels[step];
+}
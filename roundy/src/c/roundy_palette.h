@@ -2,6 +2,8 @@
 
 #include <pebble.h>
 
+#include "roundy_progress.h"
+
 static inline GColor roundy_palette_background_fill(void) {
   return GColorBlack;
 }
@@ -21,3 +23,31 @@ static inline GColor roundy_palette_digit_stroke(void) {
 static inline GColor roundy_palette_window_background(void) {
   return PBL_IF_COLOR_ELSE(GColorBlack, GColorWhite);
 }
+
+/* Transition themes. An animating cell steps through its theme's gradient,
+ * from the first colour at the start of its flip to the last just before it
+ * settles on the digit stroke. The colours for the current platform are
+ * resolved into a lookup table once per theme change, so the render path
+ * only quantizes progress and indexes the table. */
+#define ROUNDY_PALETTE_MAX_STEPS 6
+
+typedef enum {
+  /* grey to white, the original look */
+  RoundyPaletteThemeMono = 0,
+  RoundyPaletteThemeEmber,
+  RoundyPaletteThemeOcean,
+  RoundyPaletteThemeCount
+} RoundyPaletteTheme;
+
+/* Rebuilds the lookup table; layers pick it up when they are told to, see
+ * roundy_digit_layer_refresh_palette(). */
+void roundy_palette_set_theme(RoundyPaletteTheme theme);
+RoundyPaletteTheme roundy_palette_get_theme(void);
+/* Number of gradient steps of the current theme. */
+int roundy_palette_gradient_steps(void);
+/* Gradient step shown at `progress` into a cell's flip, progress < 1. */
+int roundy_palette_gradient_step(RoundyProgress progress);
+GColor roundy_palette_gradient_color(int step);
+/* Grey level of a gradient step, which black and white platforms draw
+ * through roundy_dither_rows(). */
+uint8_t roundy_palette_gradient_level(int step);
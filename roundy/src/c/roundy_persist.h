@@ -0,0 +1,10 @@
+#pragma once
+
+/* Keys of everything the watchface keeps in persistent storage. Never reuse
+ * the number of a retired key; old data may still sit under it. */
+enum {
+  /* RoundyDigitSnapshot, see roundy_digit_layer_save_snapshot() */
+  ROUNDY_PERSIST_KEY_DIGIT_SNAPSHOT = 1,
+  /* RoundySettings, see roundy_settings.h */
+  ROUNDY_PERSIST_KEY_SETTINGS = 2,
+};
@@ -0,0 +1,142 @@
+#include "roundy_power.h"
+
+#include "roundy_frame_governor.h"
+#include "roundy_render_stats.h"
+
+#define POWER_MODE_COUNT 3
+
+#if defined(ROUNDY_PROFILE)
+static const char *const s_mode_names[POWER_MODE_COUNT] = {"full", "reduced", "static"};
+#endif
+
+typedef struct {
+  RoundyPowerModeHandler handler;
+  RoundyPowerMode mode;
+  BatteryChargeState battery;
+  bool quiet_time;
+  bool asleep;
+#if defined(ROUNDY_PROFILE)
+  /* since the last midnight */
+  uint32_t avoided_frames;
+  uint16_t mode_minutes[POWER_MODE_COUNT];
+#endif
+} RoundyPower;
+
+static RoundyPower s_power;
+
+static bool prv_quiet_time(void) {
+#if PBL_API_EXISTS(quiet_time_is_active)
+  return quiet_time_is_active();
+#else
+  return false;
+#endif
+}
+
+static bool prv_asleep(void) {
+#if defined(PBL_HEALTH)
+  const HealthActivityMask sleep = HealthActivitySleep | HealthActivityRestfulSleep;
+  return (health_service_peek_current_activities() & sleep) != 0;
+#else
+  return false;
+#endif
+}
+
+static RoundyPowerMode prv_choose_mode(void) {
+  const BatteryChargeState *battery = &s_power.battery;
+  if (!battery->is_charging && !battery->is_plugged) {
+    if (battery->charge_percent <= ROUNDY_POWER_STATIC_PERCENT) {
+      return RoundyPowerModeStatic;
+    }
+    /* nobody is watching the transitions */
+    if (s_power.quiet_time || s_power.asleep) {
+      return RoundyPowerModeStatic;
+    }
+    if (battery->charge_percent <= ROUNDY_POWER_REDUCED_PERCENT) {
+      return RoundyPowerModeReduced;
+    }
+  }
+  return RoundyPowerModeFull;
+}
+
+static void prv_update(bool force) {
+  const RoundyPowerMode mode = prv_choose_mode();
+  if (mode == s_power.mode && !force) {
+    return;
+  }
+
+  s_power.mode = mode;
+#if defined(ROUNDY_PROFILE)
+  APP_LOG(APP_LOG_LEVEL_INFO, "power: %s mode, battery %d%%%s%s%s", s_mode_names[mode],
+          s_power.battery.charge_percent, s_power.battery.is_charging ? ", charging" : "",
+          s_power.quiet_time ? ", quiet time" : "", s_power.asleep ? ", asleep" : "");
+#endif
+  if (s_power.handler) {
+    s_power.handler(mode);
+  }
+}
+
+static void prv_battery_handler(BatteryChargeState charge) {
+  s_power.battery = charge;
+  prv_update(false);
+}
+
+#if defined(PBL_HEALTH)
+static void prv_health_handler(HealthEventType event, void *context) {
+  (void)context;
+  if (event == HealthEventSleepUpdate) {
+    s_power.asleep = prv_asleep();
+    prv_update(false);
+  }
+}
+#endif
+
+void roundy_power_init(RoundyPowerModeHandler handler) {
+  s_power = (RoundyPower){
+    .handler = handler,
+    .battery = battery_state_service_peek(),
+    .quiet_time = prv_quiet_time(),
+    .asleep = prv_asleep(),
+  };
+  battery_state_service_subscribe(prv_battery_handler);
+#if defined(PBL_HEALTH)
+  health_service_events_subscribe(prv_health_handler, NULL);
+#endif
+  prv_update(true);
+}
+
+void roundy_power_deinit(void) {
+  battery_state_service_unsubscribe();
+#if defined(PBL_HEALTH)
+  health_service_events_unsubscribe();
+#endif
+  s_power.handler = NULL;
+}
+
+RoundyPowerMode roundy_power_get_mode(void) {
+  return s_power.mode;
+}
+
+void roundy_power_minute(const struct tm *tick_time) {
+  /* what the last minute's transition saved, in the mode it ran in; every
+   * build reports it to the phone with the render histograms */
+  const uint32_t avoided_frames = roundy_frame_governor_take_avoided();
+  roundy_render_stats_count_avoided(avoided_frames);
+#if defined(ROUNDY_PROFILE)
+  s_power.avoided_frames += avoided_frames;
+  s_power.mode_minutes[s_power.mode]++;
+
+  if (tick_time && tick_time->tm_hour == 0 && tick_time->tm_min == 0) {
+    APP_LOG(APP_LOG_LEVEL_INFO,
+            "power: %d animation frames avoided today, %d minutes full, %d reduced, %d static",
+            (int)s_power.avoided_frames, s_power.mode_minutes[RoundyPowerModeFull],
+            s_power.mode_minutes[RoundyPowerModeReduced],
+            s_power.mode_minutes[RoundyPowerModeStatic]);
+    s_power.avoided_frames = 0;
+    memset(s_power.mode_minutes, 0, sizeof(s_power.mode_minutes));
+  }
+#endif
+
+  s_power.quiet_time = prv_quiet_time();
+  s_power.asleep = prv_asleep();
+  prv_update(false);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <pebble.h>
+
+/* Power policy. Picks how much animation the face can afford from the
+ * battery level, Quiet Time and the wearer's sleep. Every build sends how
+ * many animation frames the policy saved to the phone with the render
+ * histograms (see roundy_render_stats.h); ROUNDY_PROFILE builds also log
+ * every mode change and the day's totals at midnight:
+ *
+ *   full     every transition animates at the platform's full frame rate
+ *   reduced  transitions animate with frames at least
+ *            ROUNDY_POWER_REDUCED_FRAME_MS apart
+ *   static   new digits are drawn once, settled, without animating
+ *
+ * The minute tick stays: the face shows minutes, so a longer tick unit would
+ * leave a wrong time on screen, and in static mode a tick costs one redraw. */
+
+typedef enum {
+  RoundyPowerModeFull = 0,
+  RoundyPowerModeReduced,
+  RoundyPowerModeStatic,
+} RoundyPowerMode;
+
+/* battery levels, in percent, at or below which the mode steps down while
+ * not charging */
+#define ROUNDY_POWER_REDUCED_PERCENT 30
+#define ROUNDY_POWER_STATIC_PERCENT 10
+/* frame interval of the reduced mode, about a third of the full rate */
+#define ROUNDY_POWER_REDUCED_FRAME_MS 50
+
+typedef void (*RoundyPowerModeHandler)(RoundyPowerMode mode);
+
+/* Subscribes to the battery and health services and calls `handler` with
+ * the initial mode and on every change. */
+void roundy_power_init(RoundyPowerModeHandler handler);
+void roundy_power_deinit(void);
+RoundyPowerMode roundy_power_get_mode(void);
+/* Call on every minute tick, before updating the digits; Quiet Time has no
+ * event service, so it is polled here. */
+void roundy_power_minute(const struct tm *tick_time);
@@ -0,0 +1,128 @@
+#include "roundy_profile.h"
+
+#include "roundy_clock.h"
+
+#if defined(ROUNDY_PROFILE)
+
+/* number of frames aggregated into each log line */
+#define PROFILE_REPORT_FRAMES 64
+
+typedef struct {
+  uint32_t frame_start_ms;
+  uint32_t wall_ms;
+  uint32_t frames;
+  uint32_t draw_calls;
+  uint32_t pixel_writes;
+  uint32_t saved_writes;
+} RoundyProfileStats;
+
+static RoundyProfileStats s_stats[RoundyProfileSectionCount];
+static RoundyProfileTotals s_totals;
+
+typedef enum {
+  RoundyProfileStartupDone = 0,
+  RoundyProfileStartupFirstFrame,
+  RoundyProfileStartupSettling,
+} RoundyProfileStartupPhase;
+
+static struct {
+  RoundyProfileStartupPhase phase;
+  bool settled;
+  uint32_t start_ms;
+} s_startup;
+
+static const char *const s_section_names[RoundyProfileSectionCount] = {
+  "background",
+  "digits",
+  "compositor",
+};
+
+void roundy_profile_frame_begin(RoundyProfileSection section) {
+  s_stats[section].frame_start_ms = roundy_clock_now_ms();
+}
+
+static void prv_startup_log(const char *what) {
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "profile startup: %s after %d ms", what,
+          (int)(roundy_clock_now_ms() - s_startup.start_ms));
+}
+
+static void prv_startup_frame(void) {
+  if (s_startup.phase != RoundyProfileStartupFirstFrame) {
+    return;
+  }
+  prv_startup_log("first frame");
+  s_startup.phase = RoundyProfileStartupSettling;
+  /* settled before anything was drawn, e.g. a restored snapshot */
+  if (s_startup.settled) {
+    prv_startup_log("settled");
+    s_startup.phase = RoundyProfileStartupDone;
+  }
+}
+
+void roundy_profile_frame_end(RoundyProfileSection section) {
+  RoundyProfileStats *stats = &s_stats[section];
+  const uint32_t wall_ms = roundy_clock_now_ms() - stats->frame_start_ms;
+  stats->wall_ms += wall_ms;
+  s_totals.wall_ms += wall_ms;
+  prv_startup_frame();
+  if (++stats->frames < PROFILE_REPORT_FRAMES) {
+    return;
+  }
+
+  /* time_ms() only has millisecond resolution, the average over the report
+   * window is what carries the detail */
+  const uint32_t wall_us = (stats->wall_ms * 1000) / stats->frames;
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "profile %s: %d us wall time per frame",
+          s_section_names[section], (int)wall_us);
+
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "profile %s: %d draw calls, %d pixel writes per frame",
+          s_section_names[section], (int)(stats->draw_calls / stats->frames),
+          (int)(stats->pixel_writes / stats->frames));
+  if (stats->saved_writes) {
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "profile %s: %d pixel writes saved per frame",
+            s_section_names[section], (int)(stats->saved_writes / stats->frames));
+  }
+  *stats = (RoundyProfileStats){0};
+}
+
+void roundy_profile_count(RoundyProfileSection section, uint32_t draw_calls,
+                          uint32_t pixel_writes) {
+  s_stats[section].draw_calls += draw_calls;
+  s_stats[section].pixel_writes += pixel_writes;
+  s_totals.draw_calls += draw_calls;
+  s_totals.pixel_writes += pixel_writes;
+}
+
+void roundy_profile_get_totals(RoundyProfileTotals *totals) {
+  *totals = s_totals;
+}
+
+void roundy_profile_count_saved(RoundyProfileSection section, uint32_t pixel_writes) {
+  s_stats[section].saved_writes += pixel_writes;
+}
+
+void roundy_profile_startup(void) {
+  s_startup.phase = RoundyProfileStartupFirstFrame;
+  s_startup.settled = false;
+  s_startup.start_ms = roundy_clock_now_ms();
+}
+
+void roundy_profile_settled(void) {
+  if (s_startup.phase == RoundyProfileStartupSettling) {
+    prv_startup_log("settled");
+    s_startup.phase = RoundyProfileStartupDone;
+  } else if (s_startup.phase == RoundyProfileStartupFirstFrame) {
+    s_startup.settled = true;
+  }
+}
+
+void roundy_profile_animation(int32_t intended_ms, int32_t actual_ms,
+                              const RoundyFrameGovernorStats *frames) {
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "profile animation: %d ms intended, %d ms actual, %d frames",
+          (int)intended_ms, (int)actual_ms, (int)frames->frames);
+  APP_LOG(APP_LOG_LEVEL_DEBUG,
+          "profile animation: %d ms per frame, %d ms render cost, %d frames dropped",
+          (int)frames->frame_ms, (int)frames->render_ms, (int)frames->dropped);
+}
+
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <pebble.h>
+
+#include "roundy_frame_governor.h"
+
+/* Optional render profiling. Build with ROUNDY_PROFILE=1 in the environment
+ * (see wscript) to measure wall time, draw calls and pixel writes per
+ * update_proc and log the per-frame averages; tools/roundy_bench.py collects
+ * them from the emulators. Without it every hook compiles to nothing. */
+
+/* Running totals over all sections since start-up. */
+typedef struct {
+  uint32_t draw_calls;
+  uint32_t pixel_writes;
+  uint32_t wall_ms;
+} RoundyProfileTotals;
+
+typedef enum {
+  RoundyProfileSectionBackground = 0,
+  RoundyProfileSectionDigits,
+  RoundyProfileSectionCompositor,
+  RoundyProfileSectionCount
+} RoundyProfileSection;
+
+#if defined(ROUNDY_PROFILE)
+
+void roundy_profile_frame_begin(RoundyProfileSection section);
+void roundy_profile_frame_end(RoundyProfileSection section);
+void roundy_profile_count(RoundyProfileSection section, uint32_t draw_calls,
+                          uint32_t pixel_writes);
+/* Pixel writes avoided compared to drawing the same frame with separate
+ * layers. */
+void roundy_profile_count_saved(RoundyProfileSection section, uint32_t pixel_writes);
+void roundy_profile_get_totals(RoundyProfileTotals *totals);
+/* Logs how long an animation was meant to take, start delay included, against
+ * the wall time it actually took, along with the frame pacing it ran at. */
+void roundy_profile_animation(int32_t intended_ms, int32_t actual_ms,
+                              const RoundyFrameGovernorStats *frames);
+/* Cold start timing: call roundy_profile_startup() first thing on launch and
+ * roundy_profile_settled() once the digits stop changing. The time to the
+ * first rendered frame and to the first frame rendered after settling are
+ * logged once per launch, along with when the digits settled. */
+void roundy_profile_startup(void);
+void roundy_profile_settled(void);
+
+#else
+
+#define roundy_profile_frame_begin(section) ((void)0)
+#define roundy_profile_frame_end(section) ((void)0)
+/* functions rather than macros, so the counts callers add up for them are
+ * still used and need no casts */
+static inline void roundy_profile_count(RoundyProfileSection section, uint32_t draw_calls,
+                                        uint32_t pixel_writes) {}
+static inline void roundy_profile_count_saved(RoundyProfileSection section,
+                                              uint32_t pixel_writes) {}
+#define roundy_profile_animation(intended_ms, actual_ms, frames) ((void)0)
+#define roundy_profile_startup() ((void)0)
+#define roundy_profile_settled() ((void)0)
+
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <pebble.h>
+
+#include "roundy_layout.h"
+
+/* Animation progress as Q16 fixed-point so the render path stays in integer
+ * math (aplite and diorite have no FPU). ROUNDY_PROGRESS_ONE is 1.0. */
+#define ROUNDY_PROGRESS_SHIFT 16
+#define ROUNDY_PROGRESS_ONE ((RoundyProgress)1 << ROUNDY_PROGRESS_SHIFT)
+#define ROUNDY_PROGRESS_HALF (ROUNDY_PROGRESS_ONE / 2)
+
+typedef int32_t RoundyProgress;
+
+/* fraction elapsed_ms / duration_ms clamped to [0, 1]. Rounds up so that
+ * exact thresholds such as 1/3 or 0.1 land on the same side as in exact
+ * arithmetic. */
+static inline RoundyProgress roundy_progress(int32_t elapsed_ms, int32_t duration_ms) {
+  if (elapsed_ms <= 0) {
+    return 0;
+  }
+  if (elapsed_ms >= duration_ms) {
+    return ROUNDY_PROGRESS_ONE;
+  }
+  return ((elapsed_ms << ROUNDY_PROGRESS_SHIFT) + duration_ms - 1) / duration_ms;
+}
+
+/* x offset of row `idx` of a cell diagonal interpolated from '\' (progress 0)
+ * to '/' (progress 1), rounding half up; the offset is never negative */
+static inline int roundy_progress_diag_offset(RoundyProgress progress, int idx) {
+  const int from_x = idx;
+  const int to_x = (ROUNDY_CELL_SIZE - 1 - idx);
+  const RoundyProgress offset = (from_x * ROUNDY_PROGRESS_ONE) + (progress * (to_x - from_x));
+  return (int)((offset + ROUNDY_PROGRESS_HALF) >> ROUNDY_PROGRESS_SHIFT);
+}
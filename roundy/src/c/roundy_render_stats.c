@@ -0,0 +1,133 @@
+#include "roundy_render_stats.h"
+
+#include "roundy_clock.h"
+
+static const uint8_t s_bucket_limits_ms[] = ROUNDY_RENDER_STATS_BUCKET_LIMITS_MS;
+_Static_assert(sizeof(s_bucket_limits_ms) + 1 == ROUNDY_RENDER_STATS_BUCKET_COUNT,
+               "one bucket per limit plus the overflow bucket");
+
+static uint16_t s_buckets[RoundyProfileSectionCount][ROUNDY_RENDER_STATS_BUCKET_COUNT];
+static uint32_t s_sum_ms[RoundyProfileSectionCount];
+static uint32_t s_avoided_frames;
+/* counts in flight, added back if the phone never acknowledges them */
+static uint16_t s_sending[RoundyProfileSectionCount][ROUNDY_RENDER_STATS_BUCKET_COUNT];
+static uint32_t s_sending_sum_ms[RoundyProfileSectionCount];
+static uint32_t s_sending_avoided_frames;
+static bool s_send_pending;
+/* minutes since the phone last acknowledged the histograms, up to
+ * ROUNDY_RENDER_STATS_FLUSH_MINUTES */
+static uint16_t s_minutes;
+
+static void prv_restore_sending(void) {
+  for (int section = 0; section < RoundyProfileSectionCount; ++section) {
+    for (int bucket = 0; bucket < ROUNDY_RENDER_STATS_BUCKET_COUNT; ++bucket) {
+      const uint32_t count =
+          (uint32_t)s_buckets[section][bucket] + s_sending[section][bucket];
+      s_buckets[section][bucket] = (count > UINT16_MAX) ? UINT16_MAX : (uint16_t)count;
+    }
+    s_sum_ms[section] += s_sending_sum_ms[section];
+  }
+  s_avoided_frames += s_sending_avoided_frames;
+}
+
+static void prv_outbox_sent(DictionaryIterator *iter, void *context) {
+  (void)iter;
+  (void)context;
+  if (s_send_pending) {
+    s_minutes = 0;
+    s_send_pending = false;
+  }
+}
+
+static void prv_outbox_failed(DictionaryIterator *iter, AppMessageResult reason,
+                              void *context) {
+  (void)iter;
+  (void)reason;
+  (void)context;
+  if (s_send_pending) {
+    prv_restore_sending();
+    s_send_pending = false;
+  }
+}
+
+void roundy_render_stats_init(void) {
+  app_message_register_outbox_sent(prv_outbox_sent);
+  app_message_register_outbox_failed(prv_outbox_failed);
+}
+
+uint32_t roundy_render_stats_begin(void) {
+  return roundy_clock_now_ms();
+}
+
+void roundy_render_stats_end(RoundyProfileSection section, uint32_t start_ms) {
+  const uint32_t duration_ms = roundy_clock_now_ms() - start_ms;
+  int bucket = 0;
+  while (bucket < (int)sizeof(s_bucket_limits_ms) && duration_ms >= s_bucket_limits_ms[bucket]) {
+    ++bucket;
+  }
+  if (s_buckets[section][bucket] < UINT16_MAX) {
+    s_buckets[section][bucket]++;
+    s_sum_ms[section] += duration_ms;
+  }
+}
+
+void roundy_render_stats_count_avoided(uint32_t frames) {
+  s_avoided_frames += frames;
+}
+
+static inline size_t prv_put_u32(uint8_t *data, uint32_t value) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    *data++ = (uint8_t)(value >> shift);
+  }
+  return 4;
+}
+
+static void prv_send(void) {
+  DictionaryIterator *iter;
+  if (app_message_outbox_begin(&iter) != APP_MSG_OK) {
+    return;
+  }
+
+  uint8_t message[ROUNDY_RENDER_STATS_MESSAGE_SIZE];
+  size_t length = 0;
+  message[length++] = ROUNDY_RENDER_STATS_VERSION;
+  message[length++] = RoundyProfileSectionCount;
+  message[length++] = ROUNDY_RENDER_STATS_BUCKET_COUNT;
+  for (int section = 0; section < RoundyProfileSectionCount; ++section) {
+    for (int bucket = 0; bucket < ROUNDY_RENDER_STATS_BUCKET_COUNT; ++bucket) {
+      const uint16_t count = s_buckets[section][bucket];
+      message[length++] = (uint8_t)(count & 0xFF);
+      message[length++] = (uint8_t)(count >> 8);
+    }
+    length += prv_put_u32(&message[length], s_sum_ms[section]);
+  }
+  length += prv_put_u32(&message[length], s_avoided_frames);
+
+  dict_write_data(iter, MESSAGE_KEY_RenderHistogram, message, length);
+  if (app_message_outbox_send() != APP_MSG_OK) {
+    return;
+  }
+
+  memcpy(s_sending, s_buckets, sizeof(s_sending));
+  memcpy(s_sending_sum_ms, s_sum_ms, sizeof(s_sending_sum_ms));
+  s_sending_avoided_frames = s_avoided_frames;
+  memset(s_buckets, 0, sizeof(s_buckets));
+  memset(s_sum_ms, 0, sizeof(s_sum_ms));
+  s_avoided_frames = 0;
+  s_send_pending = true;
+}
+
+void roundy_render_stats_minute(void) {
+  if (s_minutes < ROUNDY_RENDER_STATS_FLUSH_MINUTES &&
+      ++s_minutes < ROUNDY_RENDER_STATS_FLUSH_MINUTES) {
+    return;
+  }
+  if (s_send_pending || !connection_service_peek_pebble_app_connection()) {
+    /* try again next minute */
+    return;
+  }
+
+  /* the count starts over once the phone acknowledges, so a send that
+   * fails is tried again next minute */
+  prv_send();
+}
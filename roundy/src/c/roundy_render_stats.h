@@ -0,0 +1,45 @@
+#pragma once
+
+#include <pebble.h>
+
+#include "roundy_profile.h"
+
+/* Field render timing. Every update_proc records its duration into a small
+ * fixed-bucket histogram per section; the histograms are sent to the phone
+ * every ROUNDY_RENDER_STATS_FLUSH_MINUTES while it is connected, where
+ * src/pkjs/render_stats.js aggregates them per platform. Recording is two
+ * time_ms() calls, a counter increment and an add. */
+
+#define ROUNDY_RENDER_STATS_FLUSH_MINUTES 60
+
+/* Upper bounds (exclusive) of the histogram buckets, in readings of the
+ * millisecond clock; the last bucket takes everything longer. A reading is
+ * the difference of two time_ms() values, so n means anywhere from n - 1 to
+ * n + 1 ms and finer edges would only split the same readings. The buckets
+ * hold one reading each up to 6 ms, where most frames fall. Keep
+ * src/pkjs/render_stats.js in sync. */
+#define ROUNDY_RENDER_STATS_BUCKET_LIMITS_MS {1, 2, 3, 4, 5, 6, 8, 10, 12, 16, 24, 32}
+#define ROUNDY_RENDER_STATS_BUCKET_COUNT 13
+
+/* Histogram message layout, one byte array under MESSAGE_KEY_RenderHistogram:
+ * version, section count, bucket count, then for every section its bucket
+ * counts as little-endian uint16 followed by the sum of its readings in ms
+ * as little-endian uint32. Frames shorter than a millisecond mostly read 0,
+ * but a frame of a fraction f of a millisecond reads 1 about f of the time,
+ * so the mean of the readings resolves what the buckets cannot. Since
+ * version 3 the sections are followed by the animation frames the power
+ * policy avoided (see roundy_power.h) as little-endian uint32. */
+#define ROUNDY_RENDER_STATS_VERSION 3
+#define ROUNDY_RENDER_STATS_MESSAGE_SIZE \
+  (3 + (RoundyProfileSectionCount * ((ROUNDY_RENDER_STATS_BUCKET_COUNT * 2) + 4)) + 4)
+
+/* Registers the outbox handlers; open AppMessage after calling it. */
+void roundy_render_stats_init(void);
+/* Returns the start time to pass to roundy_render_stats_end(). */
+uint32_t roundy_render_stats_begin(void);
+void roundy_render_stats_end(RoundyProfileSection section, uint32_t start_ms);
+/* Adds animation frames the power policy avoided; they go out with the next
+ * histograms. */
+void roundy_render_stats_count_avoided(uint32_t frames);
+/* Call once a minute; sends the histograms when they are due. */
+void roundy_render_stats_minute(void);
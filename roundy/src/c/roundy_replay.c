@@ -0,0 +1,284 @@
+#include "roundy_replay.h"
+
+#if defined(ROUNDY_REPLAY)
+
+#include "roundy_clock.h"
+#include "roundy_frame_dump.h"
+#include "roundy_frame_governor.h"
+#include "roundy_profile.h"
+
+#if !defined(ROUNDY_PROFILE)
+#error "ROUNDY_REPLAY needs ROUNDY_PROFILE for its measurements"
+#endif
+
+#define REPLAY_MINUTES (24 * 60)
+/* real delay behind every virtual timer; the frame marked dirty by the
+ * previous timer is rendered in between */
+#define REPLAY_TIMER_MS 1
+/* how often to check whether a transition has finished animating */
+#define REPLAY_POLL_MS 10
+
+typedef struct {
+  uint32_t frames;
+  uint32_t pixel_writes;
+  uint32_t max_frame_pixel_writes;
+  uint32_t render_ms;
+  uint32_t max_frame_render_ms;
+} RoundyReplayStats;
+
+#if defined(ROUNDY_FRAME_DUMP)
+/* golden frames cover the transitions that change several glyphs at once,
+ * plus an ordinary one; each entry is the minute transitioned to */
+static const int16_t s_golden_minutes[] = {
+  0,       /* 23:59 -> 00:00, 11:59 -> 12:00 in 12h mode */
+  1,       /* 00:00 -> 00:01 */
+  10 * 60, /* 09:59 -> 10:00 */
+  12 * 60, /* 11:59 -> 12:00 */
+  13 * 60, /* 12:59 -> 13:00, the leading digit disappears in 12h mode */
+  20 * 60, /* 19:59 -> 20:00 */
+};
+#endif
+
+static const RoundyClockFormat s_formats[] = {RoundyClockFormat24h, RoundyClockFormat12h};
+static const char *const s_format_names[] = {"24h", "12h"};
+
+typedef struct {
+  RoundyDigitLayer *layer;
+  /* virtual clock and the one pending virtual timer */
+  uint32_t virtual_ms;
+  AppTimerCallback callback;
+  void *callback_data;
+  /* position in the replay: `minute` is the target of the next transition
+   * and `shown_minute` what the layer currently shows, -1 if unknown */
+  size_t format;
+  int minute;
+  int shown_minute;
+  bool intro_pending;
+  bool intro_running;
+  bool measuring;
+  int idle_polls;
+  /* profile totals at the start of the frame being rendered */
+  RoundyProfileTotals frame_start;
+  RoundyReplayStats transition;
+  RoundyReplayStats total;
+  RoundyReplayStats worst;
+} RoundyReplay;
+
+static RoundyReplay s_replay;
+
+static int prv_from_minute(int minute) {
+  return (minute + REPLAY_MINUTES - 1) % REPLAY_MINUTES;
+}
+
+/* Transition target after `minute`, REPLAY_MINUTES once the day is done. */
+static int prv_next_minute(int minute) {
+#if defined(ROUNDY_FRAME_DUMP)
+  for (size_t i = 0; i < ARRAY_LENGTH(s_golden_minutes); ++i) {
+    if (s_golden_minutes[i] > minute) {
+      return s_golden_minutes[i];
+    }
+  }
+  return REPLAY_MINUTES;
+#else
+  return minute + 1;
+#endif
+}
+
+uint32_t roundy_clock_timeline_ms(void) {
+  return s_replay.virtual_ms;
+}
+
+static void prv_close_frame(void) {
+  RoundyProfileTotals totals;
+  roundy_profile_get_totals(&totals);
+  const uint32_t pixel_writes = totals.pixel_writes - s_replay.frame_start.pixel_writes;
+  const uint32_t render_ms = totals.wall_ms - s_replay.frame_start.wall_ms;
+  s_replay.frame_start = totals;
+
+  RoundyReplayStats *stats = &s_replay.transition;
+  stats->pixel_writes += pixel_writes;
+  stats->render_ms += render_ms;
+  if (pixel_writes > stats->max_frame_pixel_writes) {
+    stats->max_frame_pixel_writes = pixel_writes;
+  }
+  if (render_ms > stats->max_frame_render_ms) {
+    stats->max_frame_render_ms = render_ms;
+  }
+}
+
+static void prv_virtual_timer_fired(void *data) {
+  (void)data;
+  AppTimerCallback callback = s_replay.callback;
+  s_replay.callback = NULL;
+  if (!callback) {
+    return;
+  }
+
+  prv_close_frame();
+  s_replay.transition.frames++;
+  callback(s_replay.callback_data);
+}
+
+AppTimer *roundy_clock_timer_register(uint32_t delay_ms, AppTimerCallback callback,
+                                      void *data) {
+  /* jump straight to the deadline; only the animation timer runs on this
+   * clock, so there is never more than one pending */
+  s_replay.virtual_ms += delay_ms;
+  s_replay.callback = callback;
+  s_replay.callback_data = data;
+  return app_timer_register(REPLAY_TIMER_MS, prv_virtual_timer_fired, NULL);
+}
+
+static void prv_log_row(const char *from, const char *to, const RoundyReplayStats *stats) {
+  APP_LOG(APP_LOG_LEVEL_INFO, "replay,%s,%s,%s,%d,%d,%d,%d,%d",
+          s_format_names[s_replay.format], from, to, (int)stats->frames,
+          (int)stats->pixel_writes, (int)stats->max_frame_pixel_writes,
+          (int)stats->render_ms, (int)stats->max_frame_render_ms);
+}
+
+static void prv_max(uint32_t *worst, uint32_t value) {
+  if (value > *worst) {
+    *worst = value;
+  }
+}
+
+static void prv_finish_transition(void) {
+  prv_close_frame();
+
+  const int from = prv_from_minute(s_replay.minute);
+  char from_text[8];
+  char to_text[8];
+  snprintf(from_text, sizeof(from_text), "%02d:%02d", from / 60, from % 60);
+  snprintf(to_text, sizeof(to_text), "%02d:%02d", s_replay.minute / 60, s_replay.minute % 60);
+  prv_log_row(s_replay.intro_running ? "intro" : from_text,
+              s_replay.intro_running ? from_text : to_text, &s_replay.transition);
+  if (s_replay.intro_running) {
+    /* the intro is reported but kept out of the day's totals */
+    return;
+  }
+
+  const RoundyReplayStats *stats = &s_replay.transition;
+  s_replay.total.frames += stats->frames;
+  s_replay.total.pixel_writes += stats->pixel_writes;
+  s_replay.total.render_ms += stats->render_ms;
+  prv_max(&s_replay.total.max_frame_pixel_writes, stats->max_frame_pixel_writes);
+  prv_max(&s_replay.total.max_frame_render_ms, stats->max_frame_render_ms);
+  prv_max(&s_replay.worst.frames, stats->frames);
+  prv_max(&s_replay.worst.pixel_writes, stats->pixel_writes);
+  prv_max(&s_replay.worst.max_frame_pixel_writes, stats->max_frame_pixel_writes);
+  prv_max(&s_replay.worst.render_ms, stats->render_ms);
+  prv_max(&s_replay.worst.max_frame_render_ms, stats->max_frame_render_ms);
+}
+
+static void prv_set_minute(int minute) {
+  struct tm time_info = {
+    .tm_hour = minute / 60,
+    .tm_min = minute % 60,
+  };
+  roundy_digit_layer_set_time(s_replay.layer, &time_info);
+  s_replay.shown_minute = minute;
+}
+
+static void prv_begin_measuring(const char *label) {
+  prv_close_frame();
+  s_replay.transition = (RoundyReplayStats){0};
+  s_replay.measuring = true;
+  roundy_frame_dump_set_label(label);
+}
+
+/* Starts the next step: the intro flip, settling on the minute before the
+ * next transition, or the transition itself. */
+static void prv_step(void) {
+  const int from = prv_from_minute(s_replay.minute);
+  char label[24];
+
+  if (s_replay.intro_pending) {
+    s_replay.intro_pending = false;
+    s_replay.intro_running = true;
+    snprintf(label, sizeof(label), "%s-intro", s_format_names[s_replay.format]);
+    prv_begin_measuring(label);
+    prv_set_minute(from);
+    roundy_digit_layer_start_diag_flip(s_replay.layer);
+    return;
+  }
+
+  s_replay.intro_running = false;
+  if (s_replay.shown_minute != from) {
+    s_replay.measuring = false;
+    roundy_frame_dump_set_label(NULL);
+    prv_set_minute(from);
+    return;
+  }
+
+  snprintf(label, sizeof(label), "%s-%02d%02d-%02d%02d", s_format_names[s_replay.format],
+           from / 60, from % 60, s_replay.minute / 60, s_replay.minute % 60);
+  prv_begin_measuring(label);
+  prv_set_minute(s_replay.minute);
+}
+
+static void prv_start_format(void) {
+  s_replay.total = (RoundyReplayStats){0};
+  s_replay.worst = (RoundyReplayStats){0};
+  s_replay.minute = prv_next_minute(-1);
+  /* the layer shows the previous mode's format, so settle first */
+  s_replay.shown_minute = -1;
+  roundy_digit_layer_set_clock_format(s_replay.layer, s_formats[s_replay.format]);
+}
+
+/* Moves on to the next step; returns false once the replay is done. */
+static bool prv_next(void) {
+  if (s_replay.measuring) {
+    prv_finish_transition();
+    s_replay.measuring = false;
+    if (!s_replay.intro_running) {
+      s_replay.minute = prv_next_minute(s_replay.minute);
+    }
+  }
+
+  if (s_replay.minute >= REPLAY_MINUTES) {
+    prv_log_row("total", "", &s_replay.total);
+    prv_log_row("worst", "", &s_replay.worst);
+    if (++s_replay.format == ARRAY_LENGTH(s_formats)) {
+      roundy_frame_dump_set_label(NULL);
+      APP_LOG(APP_LOG_LEVEL_INFO, "replay,done");
+      return false;
+    }
+    prv_start_format();
+  }
+
+  prv_step();
+  return true;
+}
+
+static void prv_poll(void *data) {
+  (void)data;
+  /* wait for a second idle poll so the last frame has been rendered */
+  if (roundy_digit_layer_is_animating(s_replay.layer) || s_replay.callback) {
+    s_replay.idle_polls = 0;
+  } else if (++s_replay.idle_polls >= 2) {
+    s_replay.idle_polls = 0;
+    if (!prv_next()) {
+      return;
+    }
+  }
+  app_timer_register(REPLAY_POLL_MS, prv_poll, NULL);
+}
+
+void roundy_replay_start(RoundyDigitLayer *layer) {
+  if (!layer) {
+    return;
+  }
+
+  s_replay = (RoundyReplay){
+    .layer = layer,
+    .intro_pending = true,
+  };
+  roundy_frame_governor_set_adaptive(false);
+  APP_LOG(APP_LOG_LEVEL_INFO, "replay,mode,from,to,frames,pixel_writes,"
+                              "max_frame_pixel_writes,render_ms,max_frame_render_ms");
+  prv_start_format();
+  prv_step();
+  app_timer_register(REPLAY_POLL_MS, prv_poll, NULL);
+}
+
+#endif
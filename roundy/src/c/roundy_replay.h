@@ -0,0 +1,28 @@
+#pragma once
+
+#include <pebble.h>
+
+#include "roundy_digit_layer.h"
+
+/* Deterministic full-day replay. Build with ROUNDY_REPLAY=1 in the environment
+ * (see wscript) and the watchface, instead of following the clock, feeds every
+ * minute of a day through roundy_digit_layer_set_time(), first in 24h and then
+ * in 12h mode. Each animation runs to completion on a virtual clock with a
+ * fixed frame interval, so the frame counts do not depend on the host.
+ *
+ * The replay opens with the intro flip. One CSV row is logged for it and for
+ * every transition, followed by a "total" and a "worst" row per mode; collect
+ * them with `pebble logs | grep -o 'replay,.*'`:
+ *
+ *   replay,mode,from,to,frames,pixel_writes,max_frame_pixel_writes,
+ *   render_ms,max_frame_render_ms
+ *
+ * ROUNDY_FRAME_DUMP builds replay only a few golden transitions and dump
+ * every frame they render, see roundy_frame_dump.h.
+ */
+
+#if defined(ROUNDY_REPLAY)
+
+void roundy_replay_start(RoundyDigitLayer *layer);
+
+#endif
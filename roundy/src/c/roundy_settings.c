@@ -0,0 +1,107 @@
+#include "roundy_settings.h"
+
+#include "roundy_persist.h"
+
+#if defined(ROUNDY_FAST_START)
+#define SETTINGS_DEFAULT_FAST_START true
+#else
+#define SETTINGS_DEFAULT_FAST_START false
+#endif
+
+#define SETTINGS_DEFAULTS                      \
+  {                                            \
+    .version = ROUNDY_SETTINGS_VERSION,        \
+    .theme = RoundyPaletteThemeMono,           \
+    .clock_format = RoundyClockFormatSystem,   \
+    .fast_start = SETTINGS_DEFAULT_FAST_START, \
+    .speed_percent = 100,                      \
+  }
+
+static const RoundySettings s_defaults = SETTINGS_DEFAULTS;
+static RoundySettings s_settings = SETTINGS_DEFAULTS;
+static RoundySettingsHandler s_handler;
+
+/* Clamps out of range values instead of rejecting the whole message, so an
+ * older watchface still takes what it understands from a newer phone. */
+static RoundySettings prv_sanitize(RoundySettings settings) {
+  settings.version = ROUNDY_SETTINGS_VERSION;
+  if (settings.theme >= RoundyPaletteThemeCount) {
+    settings.theme = s_defaults.theme;
+  }
+  if (settings.clock_format > RoundyClockFormat24h) {
+    settings.clock_format = s_defaults.clock_format;
+  }
+  if (settings.speed_percent < ROUNDY_SETTINGS_SPEED_MIN) {
+    settings.speed_percent = ROUNDY_SETTINGS_SPEED_MIN;
+  } else if (settings.speed_percent > ROUNDY_SETTINGS_SPEED_MAX) {
+    settings.speed_percent = ROUNDY_SETTINGS_SPEED_MAX;
+  }
+  return settings;
+}
+
+static bool prv_decode(const uint8_t *data, size_t length, RoundySettings *settings) {
+  /* newer messages only append, see roundy_settings.h */
+  if (length < ROUNDY_SETTINGS_MESSAGE_SIZE || data[0] < ROUNDY_SETTINGS_VERSION) {
+    return false;
+  }
+
+  *settings = prv_sanitize((RoundySettings){
+    .speed_percent = (uint16_t)(data[1] | (data[2] << 8)),
+    .theme = data[3],
+    .clock_format = data[4],
+    .fast_start = (data[5] & ROUNDY_SETTINGS_FLAG_FAST_START) != 0,
+  });
+  return true;
+}
+
+static uint32_t prv_changes(const RoundySettings *from, const RoundySettings *to) {
+  uint32_t changed = 0;
+  if (from->speed_percent != to->speed_percent) {
+    changed |= RoundySettingsChangedSpeed;
+  }
+  if (from->theme != to->theme) {
+    changed |= RoundySettingsChangedTheme;
+  }
+  if (from->clock_format != to->clock_format) {
+    changed |= RoundySettingsChangedClockFormat;
+  }
+  if (from->fast_start != to->fast_start) {
+    changed |= RoundySettingsChangedFastStart;
+  }
+  return changed;
+}
+
+static void prv_inbox_received(DictionaryIterator *iter, void *context) {
+  (void)context;
+  Tuple *tuple = dict_find(iter, MESSAGE_KEY_Settings);
+  RoundySettings settings;
+  if (!tuple || tuple->type != TUPLE_BYTE_ARRAY ||
+      !prv_decode(tuple->value->data, tuple->length, &settings)) {
+    return;
+  }
+
+  const uint32_t changed = prv_changes(&s_settings, &settings);
+  if (!changed) {
+    return;
+  }
+  s_settings = settings;
+  persist_write_data(ROUNDY_PERSIST_KEY_SETTINGS, &s_settings, sizeof(s_settings));
+  if (s_handler) {
+    s_handler(&s_settings, changed);
+  }
+}
+
+void roundy_settings_init(RoundySettingsHandler handler) {
+  s_handler = handler;
+  RoundySettings cached;
+  if (persist_read_data(ROUNDY_PERSIST_KEY_SETTINGS, &cached, sizeof(cached)) ==
+          (int)sizeof(cached) &&
+      cached.version == ROUNDY_SETTINGS_VERSION) {
+    s_settings = prv_sanitize(cached);
+  }
+  app_message_register_inbox_received(prv_inbox_received);
+}
+
+const RoundySettings *roundy_settings_get(void) {
+  return &s_settings;
+}
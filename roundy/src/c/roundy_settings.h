@@ -0,0 +1,50 @@
+#pragma once
+
+#include <pebble.h>
+
+#include "roundy_digit_layer.h"
+#include "roundy_palette.h"
+
+/* User settings. The phone sends them all at once as one byte array under
+ * MESSAGE_KEY_Settings (src/pkjs/settings.js encodes it); the decoded struct
+ * is cached in persistent storage, so start-up uses the last settings
+ * without waiting for the phone.
+ *
+ * Message layout: version, animation speed in percent as little-endian
+ * uint16, palette theme, clock format, flags (bit 0: fast start). Later
+ * versions may only append fields and flags, so a message of this version
+ * or a newer one is read up to what this version knows; older ones are
+ * rejected. */
+
+#define ROUNDY_SETTINGS_VERSION 1
+#define ROUNDY_SETTINGS_MESSAGE_SIZE 6
+#define ROUNDY_SETTINGS_FLAG_FAST_START 0x01
+
+/* animation speed range, 100 is the face's own timing */
+#define ROUNDY_SETTINGS_SPEED_MIN 25
+#define ROUNDY_SETTINGS_SPEED_MAX 400
+
+typedef struct {
+  uint8_t version;
+  uint8_t theme;
+  uint8_t clock_format;
+  bool fast_start;
+  uint16_t speed_percent;
+} RoundySettings;
+
+/* Bits of the `changed` mask passed to the handler. */
+typedef enum {
+  RoundySettingsChangedSpeed = 1 << 0,
+  RoundySettingsChangedTheme = 1 << 1,
+  RoundySettingsChangedClockFormat = 1 << 2,
+  RoundySettingsChangedFastStart = 1 << 3,
+} RoundySettingsChanged;
+
+typedef void (*RoundySettingsHandler)(const RoundySettings *settings, uint32_t changed);
+
+/* Loads the cached settings and registers the inbox handler; open AppMessage
+ * after calling it. `handler` is called for every received message that
+ * changes something. */
+void roundy_settings_init(RoundySettingsHandler handler);
+/* The current settings; the defaults until roundy_settings_init(). */
+const RoundySettings *roundy_settings_get(void);
@@ -0,0 +1,78 @@
+#include "roundy_trace.h"
+
+#if defined(ROUNDY_TRACE)
+
+#include "roundy_clock.h"
+
+/* Each event is packed into 32 bits: the low 20 bits of the millisecond
+ * clock, the event and its argument. The clock wraps every 17 minutes, far
+ * longer than the gap between two minute ticks, so the host can unwrap it. */
+#define TRACE_TIME_BITS 20
+#define TRACE_EVENT_BITS 5
+#define TRACE_ARG_BITS 7
+#define TRACE_EVENT_SHIFT TRACE_TIME_BITS
+#define TRACE_ARG_SHIFT (TRACE_TIME_BITS + TRACE_EVENT_BITS)
+
+/* a power of two; one animated transition takes about 200 events */
+#define TRACE_CAPACITY 512
+/* events per "trace,data" line, APP_LOG truncates long messages */
+#define TRACE_LINE_EVENTS 12
+
+_Static_assert(TRACE_TIME_BITS + TRACE_EVENT_BITS + TRACE_ARG_BITS == 32,
+               "trace events are four bytes");
+_Static_assert(RoundyTraceEventCount <= (1 << TRACE_EVENT_BITS), "too many trace events");
+_Static_assert(ROUNDY_TRACE_ARG_MAX < (1 << TRACE_ARG_BITS), "trace argument too wide");
+_Static_assert((TRACE_CAPACITY & (TRACE_CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+typedef struct {
+  uint32_t events[TRACE_CAPACITY];
+  /* total events recorded and the count at the last dump */
+  uint32_t head;
+  uint32_t dumped;
+} RoundyTrace;
+
+static RoundyTrace s_trace;
+
+void roundy_trace(RoundyTraceEvent event, uint32_t arg) {
+  const uint32_t time_ms = roundy_clock_now_ms() & ((1u << TRACE_TIME_BITS) - 1);
+  if (event == RoundyTraceEventTimerRegister) {
+    arg = (arg + (ROUNDY_TRACE_DELAY_UNIT_MS / 2)) / ROUNDY_TRACE_DELAY_UNIT_MS;
+  }
+  if (arg > ROUNDY_TRACE_ARG_MAX) {
+    arg = ROUNDY_TRACE_ARG_MAX;
+  }
+  s_trace.events[s_trace.head & (TRACE_CAPACITY - 1)] =
+      time_ms | ((uint32_t)event << TRACE_EVENT_SHIFT) | (arg << TRACE_ARG_SHIFT);
+  s_trace.head++;
+}
+
+void roundy_trace_dump(void) {
+  static const char hex[] = "0123456789abcdef";
+  uint32_t start = s_trace.dumped;
+  uint32_t lost = 0;
+  if (s_trace.head - start > TRACE_CAPACITY) {
+    lost = s_trace.head - start - TRACE_CAPACITY;
+    start = s_trace.head - TRACE_CAPACITY;
+  }
+  const uint32_t end = s_trace.head;
+  s_trace.dumped = end;
+
+  APP_LOG(APP_LOG_LEVEL_INFO, "trace,dump,%d,%d", (int)(end - start), (int)lost);
+  char text[(TRACE_LINE_EVENTS * 8) + 1];
+  for (uint32_t index = start; index < end;) {
+    int length = 0;
+    for (int i = 0; i < TRACE_LINE_EVENTS && index < end; ++i, ++index) {
+      /* little-endian, the same byte order the log reader expects */
+      const uint32_t event = s_trace.events[index & (TRACE_CAPACITY - 1)];
+      for (int byte = 0; byte < 4; ++byte) {
+        const uint8_t value = (uint8_t)(event >> (byte * 8));
+        text[length++] = hex[value >> 4];
+        text[length++] = hex[value & 0x0F];
+      }
+    }
+    text[length] = '\0';
+    APP_LOG(APP_LOG_LEVEL_INFO, "trace,data,%s", text);
+  }
+}
+
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <pebble.h>
+
+/* Optional event trace. Build with ROUNDY_TRACE=1 in the environment (see
+ * wscript) to record minute ticks, timer scheduling, dirty marking and
+ * update_procs into a static ring buffer, four bytes per event, and log it
+ * at every minute tick; tools/roundy_trace.py turns the log into Chrome
+ * trace_event JSON for chrome://tracing or Perfetto. Without it every hook
+ * compiles to nothing. */
+
+typedef enum {
+  RoundyTraceEventTick = 0,
+  /* argument: the minute shown */
+  RoundyTraceEventSetTime,
+  /* argument: the delay in ms; recorded in units of
+   * ROUNDY_TRACE_DELAY_UNIT_MS */
+  RoundyTraceEventTimerRegister,
+  RoundyTraceEventTimerCancel,
+  RoundyTraceEventTimerFired,
+  /* argument for these three: a RoundyTraceLayer */
+  RoundyTraceEventMarkDirty,
+  RoundyTraceEventUpdateBegin,
+  RoundyTraceEventUpdateEnd,
+  RoundyTraceEventCount
+} RoundyTraceEvent;
+
+/* Layers named in layer events. */
+typedef enum {
+  RoundyTraceLayerBackground = 0,
+  RoundyTraceLayerDigits,
+  RoundyTraceLayerCompositor,
+} RoundyTraceLayer;
+
+/* Arguments are saturated at ROUNDY_TRACE_ARG_MAX. */
+#define ROUNDY_TRACE_ARG_MAX 127
+/* Timer delays are recorded to the nearest 8 ms, so delays up to 1016 ms fit
+ * the argument; tools/roundy_trace.py multiplies them back. */
+#define ROUNDY_TRACE_DELAY_UNIT_MS 8
+
+#if defined(ROUNDY_TRACE)
+
+void roundy_trace(RoundyTraceEvent event, uint32_t arg);
+/* Logs the events recorded since the last dump. */
+void roundy_trace_dump(void);
+
+#else
+
+#define roundy_trace(event, arg) ((void)0)
+#define roundy_trace_dump() ((void)0)
+
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+
+/* Roundy: a slow, gradual reveal where the glyphs flip one after another.
+ *
+ * Every face supplies this header from its own src/face directory; the shared
+ * engine in roundy/src/c reads it at compile time, so each face gets the same
+ * code paths with its own constants folded in. */
+
+/* how long one glyph takes to flip */
+#define ROUNDY_FACE_GLYPH_DURATION_MS 480
+/* delay between the starts of two consecutive glyphs; 0 flips them together */
+#define ROUNDY_FACE_GLYPH_STAGGER_MS 480
+/* delay before the intro flip when the face appears */
+#define ROUNDY_FACE_INTRO_DELAY_MS 240
+/* delay before a minute change starts animating */
+#define ROUNDY_FACE_MINUTE_DELAY_MS 16
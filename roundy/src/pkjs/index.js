@@ -1,11 +1,52 @@
+const renderStats = require('./render_stats');
+const settings = require('./settings');
+
 (() => {
   const TAG = 'roundy-js';
 
+  function platform() {
+    const info = Pebble.getActiveWatchInfo && Pebble.getActiveWatchInfo();
+    return (info && info.platform) || 'unknown';
+  }
+
+  function sendSettings(values) {
+    settings.send(Pebble, values, (error) => {
+      console.log(`${TAG}: settings ${error ? `not sent, ${error}` : 'sent'}`);
+    });
+  }
+
   Pebble.addEventListener('ready', () => {
     console.log(`${TAG}: ready`);
+    // the watch keeps its own copy, this only catches it up after a reinstall
+    const stored = settings.load(localStorage);
+    if (stored) {
+      sendSettings(stored);
+    }
+  });
+
+  // a configuration page closes with the settings as JSON
+  Pebble.addEventListener('webviewclosed', (event) => {
+    if (!event || !event.response) {
+      return;
+    }
+    try {
+      const values = JSON.parse(decodeURIComponent(event.response));
+      sendSettings(settings.save(localStorage, Object.assign({}, settings.load(localStorage),
+                                                             values)));
+    } catch (error) {
+      console.log(`${TAG}: malformed settings ${event.response}`);
+    }
   });
 
   Pebble.addEventListener('appmessage', (event) => {
-    console.log(`${TAG}: app message ${JSON.stringify(event.payload)}`);
+    const payload = event.payload || {};
+    if (payload.RenderHistogram) {
+      const summary = renderStats.record(localStorage, platform(), payload.RenderHistogram);
+      (summary || ['malformed render histogram']).forEach((line) => {
+        console.log(`${TAG}: render ${platform()} ${line}`);
+      });
+      return;
+    }
+    console.log(`${TAG}: app message ${JSON.stringify(payload)}`);
   });
 })();
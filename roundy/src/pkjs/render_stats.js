@@ -0,0 +1,134 @@
+// Aggregates the render timing histograms the watchface sends every hour
+// (see src/c/roundy_render_stats.h), and the animation frames its power
+// policy avoided, per watch platform, kept in localStorage so they survive
+// app restarts.
+
+// version 1 totals counted other buckets and are dropped
+const STORAGE_KEY = 'roundy-render-stats-2';
+const AVOIDED_STORAGE_KEY = 'roundy-avoided-frames';
+// version 3 appended the frames the power policy avoided to version 2
+const MIN_VERSION = 2;
+const AVOIDED_VERSION = 3;
+const SECTIONS = ['background', 'digits', 'compositor'];
+// exclusive upper bounds in millisecond clock readings, the last bucket is
+// open ended; keep in sync with ROUNDY_RENDER_STATS_BUCKET_LIMITS_MS
+const BUCKET_LIMITS_MS = [1, 2, 3, 4, 5, 6, 8, 10, 12, 16, 24, 32];
+
+function readUint32(bytes, offset) {
+  return (bytes[offset] | (bytes[offset + 1] << 8) | (bytes[offset + 2] << 16)) +
+    (bytes[offset + 3] * 0x1000000);
+}
+
+// Returns {histograms: {section: {counts: [count per bucket], sumMs}},
+// avoidedFrames} or null if the message is malformed; version 2 messages
+// avoided no frames.
+function decode(bytes) {
+  if (!bytes || bytes.length < 3 || bytes[0] < MIN_VERSION || bytes[0] > AVOIDED_VERSION) {
+    return null;
+  }
+
+  const sectionCount = bytes[1];
+  const bucketCount = bytes[2];
+  const avoidedSize = bytes[0] >= AVOIDED_VERSION ? 4 : 0;
+  if (bucketCount !== BUCKET_LIMITS_MS.length + 1 ||
+      bytes.length < 3 + (sectionCount * ((bucketCount * 2) + 4)) + avoidedSize) {
+    return null;
+  }
+
+  const histograms = {};
+  let offset = 3;
+  for (let section = 0; section < sectionCount; section++) {
+    const counts = [];
+    for (let bucket = 0; bucket < bucketCount; bucket++) {
+      counts.push(bytes[offset] | (bytes[offset + 1] << 8));
+      offset += 2;
+    }
+    const sumMs = readUint32(bytes, offset);
+    offset += 4;
+    histograms[SECTIONS[section] || `section${section}`] = { counts, sumMs };
+  }
+  return { histograms, avoidedFrames: avoidedSize ? readUint32(bytes, offset) : 0 };
+}
+
+function merge(total, histograms) {
+  Object.keys(histograms).forEach((section) => {
+    const histogram = histograms[section];
+    const sum = total[section] || { counts: histogram.counts.map(() => 0), sumMs: 0 };
+    histogram.counts.forEach((count, bucket) => {
+      sum.counts[bucket] += count;
+    });
+    sum.sumMs += histogram.sumMs;
+    total[section] = sum;
+  });
+  return total;
+}
+
+// Readings are whole milliseconds, so a bucket is labelled with the readings
+// it holds: "2ms" is a reading of 2, anything from 1 to 3 ms.
+function bucketLabel(bucket) {
+  const low = bucket === 0 ? 0 : BUCKET_LIMITS_MS[bucket - 1];
+  if (bucket >= BUCKET_LIMITS_MS.length) {
+    return `>=${low}ms`;
+  }
+  const high = BUCKET_LIMITS_MS[bucket] - 1;
+  return high === low ? `${low}ms` : `${low}-${high}ms`;
+}
+
+// Upper bound of the bucket holding the given fraction of all frames.
+function percentile(counts, fraction) {
+  const frames = counts.reduce((sum, count) => sum + count, 0);
+  let seen = 0;
+  for (let bucket = 0; bucket < counts.length; bucket++) {
+    seen += counts[bucket];
+    if (frames > 0 && seen >= frames * fraction) {
+      return bucketLabel(bucket);
+    }
+  }
+  return '-';
+}
+
+// The mean of the readings resolves below a millisecond over many frames,
+// where the percentiles cannot.
+function summarize(total) {
+  return Object.keys(total).map((section) => {
+    const { counts, sumMs } = total[section];
+    const frames = counts.reduce((sum, count) => sum + count, 0);
+    const mean = frames > 0 ? (sumMs / frames).toFixed(2) : '-';
+    return `${section}: ${frames} frames, mean ${mean}ms, p50 ${percentile(counts, 0.5)}, ` +
+      `p90 ${percentile(counts, 0.9)}, p99 ${percentile(counts, 0.99)}`;
+  });
+}
+
+function load(storage, key) {
+  try {
+    return JSON.parse(storage.getItem(key)) || {};
+  } catch (error) {
+    return {};
+  }
+}
+
+// Adds one message to the platform's totals and returns the summary lines.
+function record(storage, platform, bytes) {
+  const message = decode(bytes);
+  if (!message) {
+    return null;
+  }
+
+  const platforms = load(storage, STORAGE_KEY);
+  platforms[platform] = merge(platforms[platform] || {}, message.histograms);
+  storage.setItem(STORAGE_KEY, JSON.stringify(platforms));
+
+  const avoided = load(storage, AVOIDED_STORAGE_KEY);
+  avoided[platform] = (avoided[platform] || 0) + message.avoidedFrames;
+  storage.setItem(AVOIDED_STORAGE_KEY, JSON.stringify(avoided));
+  return summarize(platforms[platform])
+    .concat([`power policy: ${avoided[platform]} animation frames avoided`]);
+}
+
+module.exports = {
+  decode,
+  merge,
+  percentile,
+  record,
+  summarize,
+};
@@ -0,0 +1,101 @@
+// Watchface settings, kept in localStorage and sent to the watch as one byte
+// array under the Settings message key; src/c/roundy_settings.h decodes it
+// and keeps its own copy, so the watch never waits for the phone at start-up.
+//
+// Everything talks to Pebble and localStorage through its arguments, so the
+// module runs under Node with stand-ins for both.
+
+const STORAGE_KEY = 'roundy-settings';
+// layout: version, speed percent (uint16 LE), theme, clock format, flags;
+// keep in sync with ROUNDY_SETTINGS_VERSION and ROUNDY_SETTINGS_MESSAGE_SIZE.
+// Later versions may only append, so both sides read the fields they know
+// from messages of their version or newer.
+const VERSION = 1;
+const MESSAGE_SIZE = 6;
+const FLAG_FAST_START = 0x01;
+const SPEED_MIN = 25;
+const SPEED_MAX = 400;
+// in the order of RoundyPaletteTheme and RoundyClockFormat
+const THEMES = ['mono', 'ember', 'ocean'];
+const CLOCK_FORMATS = ['system', '12h', '24h'];
+
+const DEFAULTS = {
+  speed: 100,
+  theme: 'mono',
+  clockFormat: 'system',
+  fastStart: false,
+};
+
+// Fills in defaults and clamps everything to what the watch accepts.
+function normalize(settings) {
+  const input = settings || {};
+  const speed = Math.round(Number(input.speed));
+  return {
+    speed: isFinite(speed) ? Math.min(SPEED_MAX, Math.max(SPEED_MIN, speed)) : DEFAULTS.speed,
+    theme: THEMES.indexOf(input.theme) >= 0 ? input.theme : DEFAULTS.theme,
+    clockFormat: CLOCK_FORMATS.indexOf(input.clockFormat) >= 0 ? input.clockFormat
+                                                               : DEFAULTS.clockFormat,
+    fastStart: input.fastStart === undefined ? DEFAULTS.fastStart : Boolean(input.fastStart),
+  };
+}
+
+function encode(settings) {
+  const normalized = normalize(settings);
+  return [
+    VERSION,
+    normalized.speed & 0xFF,
+    normalized.speed >> 8,
+    THEMES.indexOf(normalized.theme),
+    CLOCK_FORMATS.indexOf(normalized.clockFormat),
+    normalized.fastStart ? FLAG_FAST_START : 0,
+  ];
+}
+
+// Returns the settings or null if the bytes are malformed or older than
+// VERSION.
+function decode(bytes) {
+  if (!bytes || bytes.length < MESSAGE_SIZE || bytes[0] < VERSION) {
+    return null;
+  }
+
+  return normalize({
+    speed: bytes[1] | (bytes[2] << 8),
+    theme: THEMES[bytes[3]],
+    clockFormat: CLOCK_FORMATS[bytes[4]],
+    fastStart: (bytes[5] & FLAG_FAST_START) !== 0,
+  });
+}
+
+// The stored settings, or null if the user never changed any.
+function load(storage) {
+  try {
+    const stored = JSON.parse(storage.getItem(STORAGE_KEY));
+    return stored ? normalize(stored) : null;
+  } catch (error) {
+    return null;
+  }
+}
+
+function save(storage, settings) {
+  const normalized = normalize(settings);
+  storage.setItem(STORAGE_KEY, JSON.stringify(normalized));
+  return normalized;
+}
+
+// Sends the settings; `done` gets an error message or null.
+function send(pebble, settings, done) {
+  const callback = done || (() => {});
+  pebble.sendAppMessage({ Settings: encode(settings) },
+    () => callback(null),
+    (event) => callback((event && event.error && event.error.message) || 'send failed'));
+}
+
+module.exports = {
+  DEFAULTS,
+  decode,
+  encode,
+  load,
+  normalize,
+  save,
+  send,
+};
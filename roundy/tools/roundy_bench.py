@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""Benchmark the render path on the Pebble emulators.
+
+The numbers to compare builds by come from the host harness in roundy/host
+(`make -C roundy/host bench`), which runs the same engine without the SDK or
+an emulator and reports the same per-update_proc columns. This script is for
+seeing them on the emulators' own firmware as well.
+
+Builds the watchface with ROUNDY_PROFILE=1 (and optionally
+ROUNDY_COMPOSITOR=1), installs it on each emulator in turn, collects the
+profile lines the app logs while its start-up animation runs and prints the
+per-update_proc averages: wall time, draw calls and pixel writes, along
+with the time to the first frame and until the digits settled.
+
+The default platforms cover the three display geometries: basalt (144x168),
+chalk (180x180 round) and emery (200x228). Wall times come from the
+emulator, so compare them between builds on the same machine rather than
+reading them as on-watch numbers; draw calls and pixel writes are exact.
+
+--fast-start builds with ROUNDY_FAST_START=1. The snapshot it starts from is
+written when the app exits, so run the benchmark twice and read the second
+run's start-up columns.
+
+usage: roundy_bench.py [--platforms basalt chalk emery] [--seconds 8]
+                       [--compositor] [--fast-start] [--no-build]
+"""
+
+import argparse
+import collections
+import os
+import re
+import subprocess
+import sys
+import time
+
+PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# "profile digits: 3 draw calls, 108 pixel writes per frame"
+PROFILE_RE = re.compile(r'profile (\w+): (.*)$')
+METRICS = [
+    ('wall_us', re.compile(r'(\d+) us wall time per frame')),
+    ('draw_calls', re.compile(r'(\d+) draw calls, \d+ pixel writes per frame')),
+    ('pixel_writes', re.compile(r'\d+ draw calls, (\d+) pixel writes per frame')),
+    ('saved_writes', re.compile(r'(\d+) pixel writes saved per frame')),
+    # "profile startup: first frame after 95 ms", logged once per launch
+    ('first_frame_ms', re.compile(r'first frame after (\d+) ms')),
+    ('settled_ms', re.compile(r'settled after (\d+) ms')),
+]
+
+
+def pebble(*args, **kwargs):
+    return subprocess.run(['pebble'] + list(args), cwd=PROJECT_DIR, check=True, **kwargs)
+
+
+def build(compositor, fast_start):
+    env = dict(os.environ, ROUNDY_PROFILE='1')
+    for name, enabled in (('ROUNDY_COMPOSITOR', compositor), ('ROUNDY_FAST_START', fast_start)):
+        if enabled:
+            env[name] = '1'
+        else:
+            env.pop(name, None)
+    pebble('build', env=env)
+
+
+def collect(platform, seconds):
+    """Install on `platform` and return {section: {metric: [samples]}}."""
+    pebble('install', '--emulator', platform)
+    logs = subprocess.Popen(['pebble', 'logs', '--emulator', platform], cwd=PROJECT_DIR,
+                            stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True)
+    samples = collections.defaultdict(lambda: collections.defaultdict(list))
+    deadline = time.time() + seconds
+    try:
+        # the app restarts on install, so the start-up animation runs now
+        while time.time() < deadline:
+            line = logs.stdout.readline()
+            if not line:
+                break
+            match = PROFILE_RE.search(line.strip())
+            if not match:
+                continue
+            section, text = match.groups()
+            for name, pattern in METRICS:
+                metric = pattern.search(text)
+                if metric:
+                    samples[section][name].append(int(metric.group(1)))
+    finally:
+        logs.terminate()
+        logs.wait()
+    return samples
+
+
+def report(results):
+    header = '{:<8} {:<11} {:>9} {:>11} {:>13} {:>13} {:>15} {:>11}'.format(
+        'platform', 'section', 'wall us', 'draw calls', 'pixel writes', 'saved writes',
+        'first frame ms', 'settled ms')
+    print(header)
+    print('-' * len(header))
+    for platform, samples in results:
+        if not samples:
+            print('{:<8} no profile output, is the app running?'.format(platform))
+            continue
+        for section in sorted(samples):
+            values = samples[section]
+            cells = []
+            for name, _ in METRICS:
+                series = values.get(name)
+                cells.append(str(sum(series) // len(series)) if series else '-')
+            print('{:<8} {:<11} {:>9} {:>11} {:>13} {:>13} {:>15} {:>11}'.format(
+                platform, section, *cells))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--platforms', nargs='+', default=['basalt', 'chalk', 'emery'])
+    parser.add_argument('--seconds', type=float, default=8,
+                        help='how long to collect logs on each emulator')
+    parser.add_argument('--compositor', action='store_true',
+                        help='benchmark the single-pass compositor build')
+    parser.add_argument('--fast-start', action='store_true',
+                        help='start from the digits persisted by the previous run')
+    parser.add_argument('--no-build', action='store_true',
+                        help='reuse the current build, it must have been built with '
+                             'ROUNDY_PROFILE=1')
+    args = parser.parse_args()
+
+    if not args.no_build:
+        build(args.compositor, args.fast_start)
+    results = [(platform, collect(platform, args.seconds)) for platform in args.platforms]
+    report(results)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,83 @@
+"""Shared build rules for the watchfaces built on the roundy engine.
+
+Every face is its own Pebble project, with its own package.json (UUID, name,
+message keys) and a src/face/roundy_face_config.h holding its compile-time
+parameters. The C sources, glyph art and phone-side JS all come from the
+roundy project. A face's wscript calls build_face() with the node of the
+roundy project; see roundy/wscript and connected/wscript.
+"""
+
+import os
+import sys
+
+
+def build_face(ctx, engine):
+    build_worker = ctx.path.find_node('worker_src') is not None
+    binaries = []
+
+    cached_env = ctx.env
+    for platform in ctx.env.TARGET_PLATFORMS:
+        ctx.env = ctx.all_envs[platform]
+        if os.environ.get('ROUNDY_PROFILE'):
+            # log draw calls and pixel writes per frame, see src/c/roundy_profile.h
+            ctx.env.append_unique('DEFINES', 'ROUNDY_PROFILE')
+        if os.environ.get('ROUNDY_COMPOSITOR'):
+            # draw background and digits in a single pass, see
+            # src/c/roundy_compositor_layer.h
+            ctx.env.append_value('DEFINES', 'ROUNDY_COMPOSITOR')
+        if os.environ.get('ROUNDY_STATIC_ALLOC'):
+            # keep the layer wrappers, the digit state and the bitmap pixels
+            # in static storage instead of the heap, see src/c/roundy_app.c
+            ctx.env.append_value('DEFINES', 'ROUNDY_STATIC_ALLOC')
+        if os.environ.get('ROUNDY_FAST_START'):
+            # turn the fast start setting on by default: show the digits
+            # persisted by the previous session in the first frame instead of
+            # running the intro, see src/c/roundy_settings.h
+            ctx.env.append_value('DEFINES', 'ROUNDY_FAST_START')
+        if os.environ.get('ROUNDY_TRACE'):
+            # record timers, dirty marking and update_procs into a ring buffer
+            # logged every minute, see src/c/roundy_trace.h
+            ctx.env.append_value('DEFINES', 'ROUNDY_TRACE')
+        if os.environ.get('ROUNDY_FRAME_DUMP'):
+            # log every frame of a few replayed transitions for the golden
+            # frame check, see src/c/roundy_frame_dump.h
+            ctx.env.append_value('DEFINES', 'ROUNDY_FRAME_DUMP')
+        if os.environ.get('ROUNDY_REPLAY') or os.environ.get('ROUNDY_FRAME_DUMP'):
+            # replay a whole day of minute changes instead of following the
+            # clock, see src/c/roundy_replay.h; it measures through the profiler
+            ctx.env.append_unique('DEFINES', ['ROUNDY_REPLAY', 'ROUNDY_PROFILE'])
+        ctx.set_group(ctx.env.PLATFORM_NAME)
+
+        # roundy_glyphs.c is generated from the glyph art; it lives in the build
+        # directory, so point the compiler back at the headers in src/c
+        glyphs_c = ctx.path.get_bld().make_node('{}/roundy_glyphs.c'.format(ctx.env.BUILD_DIR))
+        ctx(rule='"{}" ${{SRC[0].abspath()}} ${{SRC[1].abspath()}} ${{TGT[0].abspath()}}'.format(
+                sys.executable),
+            source=[engine.find_node('tools/roundy_glyphgen.py'),
+                    engine.find_node('src/glyphs/roundy_glyphs.txt')],
+            target=glyphs_c)
+        # the face's config header comes first, the engine has none of its own
+        ctx.env.append_unique('INCLUDES', [ctx.path.find_node('src/face').abspath(),
+                                           engine.find_node('src/c').abspath()])
+
+        app_elf = '{}/pebble-app.elf'.format(ctx.env.BUILD_DIR)
+        ctx.pbl_build(source=engine.ant_glob('src/c/**/*.c') + [glyphs_c], target=app_elf,
+                      bin_type='app')
+
+        if build_worker:
+            worker_elf = '{}/pebble-worker.elf'.format(ctx.env.BUILD_DIR)
+            binaries.append({'platform': platform, 'app_elf': app_elf, 'worker_elf': worker_elf})
+            ctx.pbl_build(source=ctx.path.ant_glob('worker_src/c/**/*.c'),
+                          target=worker_elf,
+                          bin_type='worker')
+        else:
+            binaries.append({'platform': platform, 'app_elf': app_elf})
+    ctx.env = cached_env
+
+    ctx.set_group('bundle')
+    ctx.pbl_bundle(binaries=binaries,
+                   js=engine.ant_glob(['src/pkjs/**/*.js',
+                                       'src/pkjs/**/*.json',
+                                       'src/common/**/*.js']),
+                   js_entry_file=os.path.relpath(
+                       engine.find_node('src/pkjs/index.js').abspath(), ctx.path.abspath()))
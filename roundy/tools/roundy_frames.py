@@ -0,0 +1,236 @@
+#!/usr/bin/env python3
+"""Record golden frames from the emulators and diff against them.
+
+A ROUNDY_FRAME_DUMP=1 build replays the intro flip and a few minute
+transitions and logs every frame it renders (see src/c/roundy_frame_dump.h).
+This script turns those logs into images, one directory per platform and
+transition, and compares two such trees pixel by pixel:
+
+  roundy_frames.py record --platform basalt --out frames      # build, run, save
+  roundy_frames.py extract pebble.log --platform basalt --out frames
+  roundy_frames.py compare golden frames
+
+Colour frames are written as PPM, 1-bit frames as PGM. Record the golden tree
+once from a known good build, check it in, and run `compare` after every
+change to the renderer; it exits non-zero if any frame differs.
+
+roundy/host writes the same trees without an emulator and keeps the checked-in
+golden frames (`make -C roundy/host check`).
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import zlib
+
+PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+FRAME_RE = re.compile(r'dump,frame,([^,]+),(\d+),(\d+),(\d+),(\d+),([0-9a-f]{8})')
+ROW_RE = re.compile(r'dump,row,([^,]+),(\d+),(\d+),(\d+),([0-9a-f]*)')
+
+
+class Frame(object):
+    def __init__(self, label, index, width, height, bits_per_pixel, crc):
+        self.label = label
+        self.index = index
+        self.width = width
+        self.height = height
+        self.bits_per_pixel = bits_per_pixel
+        self.crc = crc
+        # y -> [(x, bytes)], in log order
+        self.rows = {}
+
+    def add_row(self, y, x, data):
+        self.rows.setdefault(y, []).append((x, data))
+
+    def check_crc(self):
+        crc = 0
+        for y in range(self.height):
+            for _, data in self.rows.get(y, []):
+                crc = zlib.crc32(data, crc)
+        return (crc & 0xffffffff) == self.crc
+
+    def pixels(self):
+        """Rows of (r, g, b) tuples; pixels outside the logged spans are black."""
+        image = [[(0, 0, 0)] * self.width for _ in range(self.height)]
+        for y, chunks in self.rows.items():
+            for x, data in chunks:
+                if self.bits_per_pixel == 1:
+                    # packed LSB first, a set bit is white
+                    for i in range(len(data) * 8):
+                        if x + i < self.width:
+                            value = 255 if data[i // 8] & (1 << (i % 8)) else 0
+                            image[y][x + i] = (value, value, value)
+                else:
+                    # GColor8 is 0bAARRGGBB
+                    for i, argb in enumerate(data):
+                        if x + i < self.width:
+                            image[y][x + i] = (((argb >> 4) & 3) * 85, ((argb >> 2) & 3) * 85,
+                                               (argb & 3) * 85)
+        return image
+
+
+def parse_log(lines):
+    frames = []
+    current = None
+    for line in lines:
+        match = FRAME_RE.search(line)
+        if match:
+            label, index, width, height, bpp, crc = match.groups()
+            current = Frame(label, int(index), int(width), int(height), int(bpp), int(crc, 16))
+            frames.append(current)
+            continue
+        match = ROW_RE.search(line)
+        if match and current:
+            label, index, y, x, data = match.groups()
+            if label == current.label and int(index) == current.index:
+                current.add_row(int(y), int(x), bytes.fromhex(data))
+    return frames
+
+
+def write_image(path, frame):
+    image = frame.pixels()
+    with open(path, 'wb') as out:
+        if frame.bits_per_pixel == 1:
+            out.write('P5\n{} {}\n255\n'.format(frame.width, frame.height).encode())
+            out.write(bytes(pixel[0] for row in image for pixel in row))
+        else:
+            out.write('P6\n{} {}\n255\n'.format(frame.width, frame.height).encode())
+            out.write(bytes(channel for row in image for pixel in row for channel in pixel))
+
+
+def read_image(path):
+    with open(path, 'rb') as image:
+        data = image.read()
+    # only the images written above are read back: their channel values are
+    # multiples of 85, never whitespace, so the header splits cleanly
+    fields = data.split(None, 4)
+    magic, width, height = fields[0], int(fields[1]), int(fields[2])
+    pixels = fields[4]
+    channels = 3 if magic == b'P6' else 1
+    rows = []
+    for y in range(height):
+        start = y * width * channels
+        rows.append([tuple(pixels[start + x * channels:start + (x + 1) * channels])
+                     for x in range(width)])
+    return rows
+
+
+def save_frames(frames, out_dir, platform):
+    bad = 0
+    for frame in frames:
+        if not frame.check_crc():
+            print('{} frame {}: CRC mismatch, the log is incomplete'.format(frame.label,
+                                                                           frame.index))
+            bad += 1
+            continue
+        directory = os.path.join(out_dir, platform, frame.label)
+        if not os.path.isdir(directory):
+            os.makedirs(directory)
+        extension = 'pgm' if frame.bits_per_pixel == 1 else 'ppm'
+        write_image(os.path.join(directory, '{:04d}.{}'.format(frame.index, extension)), frame)
+    print('{}: {} frames written to {}'.format(platform, len(frames) - bad, out_dir))
+    return bad == 0
+
+
+def record(args):
+    if not args.no_build:
+        env = dict(os.environ, ROUNDY_FRAME_DUMP='1')
+        subprocess.run(['pebble', 'build'], cwd=PROJECT_DIR, env=env, check=True)
+    subprocess.run(['pebble', 'install', '--emulator', args.platform], cwd=PROJECT_DIR,
+                   check=True)
+    logs = subprocess.Popen(['pebble', 'logs', '--emulator', args.platform], cwd=PROJECT_DIR,
+                            stdout=subprocess.PIPE, universal_newlines=True)
+    lines = []
+    try:
+        for line in logs.stdout:
+            lines.append(line)
+            if 'replay,done' in line:
+                break
+    finally:
+        logs.terminate()
+        logs.wait()
+    return save_frames(parse_log(lines), args.out, args.platform)
+
+
+def extract(args):
+    with open(args.log) as log:
+        return save_frames(parse_log(log), args.out, args.platform)
+
+
+def list_images(root):
+    images = set()
+    for directory, _, files in os.walk(root):
+        for name in files:
+            if name.endswith(('.ppm', '.pgm')):
+                images.add(os.path.relpath(os.path.join(directory, name), root))
+    return images
+
+
+def same_file(path_a, path_b):
+    with open(path_a, 'rb') as a, open(path_b, 'rb') as b:
+        return a.read() == b.read()
+
+
+def compare(args):
+    golden = list_images(args.golden)
+    actual = list_images(args.actual)
+    failures = 0
+    for name in sorted(golden - actual):
+        print('missing  {}'.format(name))
+        failures += 1
+    for name in sorted(actual - golden):
+        print('extra    {}'.format(name))
+        failures += 1
+    for name in sorted(golden & actual):
+        if same_file(os.path.join(args.golden, name), os.path.join(args.actual, name)):
+            continue
+        expected = read_image(os.path.join(args.golden, name))
+        got = read_image(os.path.join(args.actual, name))
+        if len(expected) != len(got) or len(expected[0]) != len(got[0]):
+            print('size     {}'.format(name))
+            failures += 1
+            continue
+        diff = [(x, y) for y, (row_a, row_b) in enumerate(zip(expected, got))
+                for x, (a, b) in enumerate(zip(row_a, row_b)) if a != b]
+        if diff:
+            xs = [x for x, _ in diff]
+            ys = [y for _, y in diff]
+            print('differs  {}: {} pixels in x {}..{}, y {}..{}'.format(
+                name, len(diff), min(xs), max(xs), min(ys), max(ys)))
+            failures += 1
+    print('{} frames compared, {} problems'.format(len(golden | actual), failures))
+    return failures == 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    commands = parser.add_subparsers(dest='command')
+    commands.required = True
+
+    record_parser = commands.add_parser('record', help='build, run on an emulator, save frames')
+    record_parser.add_argument('--platform', required=True)
+    record_parser.add_argument('--out', required=True)
+    record_parser.add_argument('--no-build', action='store_true',
+                               help='reuse a build made with ROUNDY_FRAME_DUMP=1')
+    record_parser.set_defaults(run=record)
+
+    extract_parser = commands.add_parser('extract', help='save the frames of a captured log')
+    extract_parser.add_argument('log')
+    extract_parser.add_argument('--platform', required=True)
+    extract_parser.add_argument('--out', required=True)
+    extract_parser.set_defaults(run=extract)
+
+    compare_parser = commands.add_parser('compare', help='diff two frame trees')
+    compare_parser.add_argument('golden')
+    compare_parser.add_argument('actual')
+    compare_parser.set_defaults(run=compare)
+
+    args = parser.parse_args()
+    return 0 if args.run(args) else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
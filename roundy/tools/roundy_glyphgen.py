@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""Generate roundy_glyphs.c from the glyph art in src/glyphs/roundy_glyphs.txt.
+
+Besides the ROUNDY_GLYPHS bitboards this emits, for every glyph, its lit
+cells sorted by diagonal index (row + col) together with the offset at which
+each diagonal starts, so the digit layer can walk only the diagonals an
+animation has reached.
+
+usage: roundy_glyphgen.py <glyph art> <output .c>
+"""
+
+import sys
+
+GLYPH_NAMES = ['0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'colon']
+
+
+def parse_art(path):
+    glyphs = {}
+    name = None
+    with open(path) as art:
+        for lineno, line in enumerate(art, 1):
+            line = line.strip()
+            if not line or (line.startswith('#') and name is None):
+                continue
+            if line.startswith('glyph '):
+                name = line.split(None, 1)[1]
+                if name in glyphs:
+                    raise ValueError('{}:{}: glyph {} defined twice'.format(path, lineno, name))
+                glyphs[name] = []
+                continue
+            if name is None or set(line) - set('#.'):
+                raise ValueError('{}:{}: unexpected line {!r}'.format(path, lineno, line))
+            if glyphs[name] and len(line) != len(glyphs[name][0]):
+                raise ValueError('{}:{}: glyph {} has rows of different widths'.format(
+                    path, lineno, name))
+            glyphs[name].append(line)
+
+    missing = [n for n in GLYPH_NAMES if n not in glyphs]
+    extra = [n for n in glyphs if n not in GLYPH_NAMES]
+    if missing or extra:
+        raise ValueError('{}: missing glyphs {} / unknown glyphs {}'.format(path, missing, extra))
+    return [glyphs[n] for n in GLYPH_NAMES]
+
+
+def generate(glyphs):
+    height = len(glyphs[0])
+    out = [
+        '/* Generated by tools/roundy_glyphgen.py from src/glyphs/roundy_glyphs.txt.',
+        ' * Do not edit, change the glyph art instead. */',
+        '#include "roundy_glyphs.h"',
+        '',
+        '_Static_assert(ROUNDY_GLYPH_COUNT == {}, "glyph art out of sync");'.format(len(glyphs)),
+        '_Static_assert(ROUNDY_DIGIT_HEIGHT == {}, "glyph art out of sync");'.format(height),
+        '',
+        '/* One row mask per glyph row, most significant of `width` bits is the left',
+        ' * column; rows are left aligned in the bitboard stride. */',
+        '#define GLYPH_ROW(width, row, mask) \\',
+        '  ((RoundyBitboard)(mask) << (((row) * ROUNDY_GLYPH_STRIDE) + ROUNDY_GLYPH_STRIDE - (width)))',
+        '',
+        'const RoundyGlyph ROUNDY_GLYPHS[ROUNDY_GLYPH_COUNT] = {',
+    ]
+    for name, rows in zip(GLYPH_NAMES, glyphs):
+        if len(rows) != height:
+            raise ValueError('glyph {} has {} rows, expected {}'.format(name, len(rows), height))
+        width = len(rows[0])
+        masks = ['GLYPH_ROW({}, {}, 0x{:02X})'.format(
+            width, r, int(row.replace('#', '1').replace('.', '0'), 2)) for r, row in enumerate(rows)]
+        out.append('  {{ // {}'.format(name))
+        out.append('    .width = {},'.format(width))
+        out.append('    .cells = ' + ' |\n             '.join(masks) + ',')
+        out.append('  },')
+    out.append('};')
+    out.append('')
+
+    cells = []
+    spans = []
+    for name, rows in zip(GLYPH_NAMES, glyphs):
+        width = len(rows[0])
+        lit = sorted(((r + c, r, c) for r, row in enumerate(rows)
+                      for c, ch in enumerate(row) if ch == '#'))
+        diag_start = []
+        for diag in range(width + height):
+            diag_start.append(sum(1 for d, _, _ in lit if d < diag))
+        spans.append((name, len(cells), width, diag_start))
+        cells.extend((name, r, c) for _, r, c in lit)
+
+    out.append('const RoundyGlyphCell ROUNDY_GLYPH_CELLS[] = {')
+    for name, r, c in cells:
+        out.append('  {{ .row = {}, .col = {} }}, // {}'.format(r, c, name))
+    out.append('};')
+    out.append('')
+    out.append('const RoundyGlyphSpans ROUNDY_GLYPH_SPANS[ROUNDY_GLYPH_COUNT] = {')
+    for name, first, width, diag_start in spans:
+        out.append('  {{ // {}'.format(name))
+        out.append('    .first_cell = {},'.format(first))
+        out.append('    .diag_start = {{{}}},'.format(', '.join(str(d) for d in diag_start)))
+        out.append('  },')
+    out.append('};')
+    out.append('')
+    out.append('_Static_assert(sizeof(ROUNDY_GLYPH_SPANS[0].diag_start) >= {},'.format(
+        max(len(s[3]) for s in spans)))
+    out.append('               "ROUNDY_GLYPH_DIAG_COUNT too small for the glyph art");')
+    out.append('')
+    return '\n'.join(out)
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write(__doc__)
+        return 2
+    source = generate(parse_art(argv[1]))
+    with open(argv[2], 'w') as out:
+        out.write(source)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""Convert the event trace of a ROUNDY_TRACE=1 build to Chrome trace JSON.
+
+The watchface logs its trace ring buffer at every minute tick (see
+src/c/roundy_trace.h). Capture the log and convert it:
+
+  ROUNDY_TRACE=1 pebble build && pebble install --emulator basalt
+  pebble logs --emulator basalt > pebble.log
+  roundy_trace.py pebble.log --out trace.json
+
+then load trace.json in chrome://tracing or https://ui.perfetto.dev. Each
+layer gets its own track with its update_procs as slices; timers show up as
+async slices from registration to firing, annotated with how late they fired.
+The watch records timer delays to the nearest 8 ms, so the lateness is good
+to within 4 ms.
+"""
+
+import argparse
+import json
+import re
+import sys
+
+DUMP_RE = re.compile(r'trace,dump,(\d+),(\d+)')
+DATA_RE = re.compile(r'trace,data,([0-9a-f]*)')
+
+# keep in sync with RoundyTraceEvent and the packing in src/c/roundy_trace.c
+EVENTS = ['tick', 'set_time', 'timer_register', 'timer_cancel', 'timer_fired', 'mark_dirty',
+          'update_begin', 'update_end']
+LAYERS = ['background', 'digits', 'compositor']
+TIME_BITS = 20
+EVENT_BITS = 5
+# ROUNDY_TRACE_DELAY_UNIT_MS, the unit of timer_register arguments
+DELAY_UNIT_MS = 8
+
+PID = 1
+APP_TID = 1
+# layer tracks follow the app track
+LAYER_TID = 10
+
+
+def layer_name(layer):
+    return LAYERS[layer] if layer < len(LAYERS) else 'layer{}'.format(layer)
+
+
+def parse_log(lines):
+    """Yields (time_ms, event, arg) with the clock unwrapped."""
+    wraps = 0
+    last_time = None
+    for line in lines:
+        match = DUMP_RE.search(line)
+        if match and int(match.group(2)):
+            print('{} events lost, the buffer overflowed between dumps'.format(match.group(2)),
+                  file=sys.stderr)
+            continue
+        match = DATA_RE.search(line)
+        if not match:
+            continue
+        data = bytes.fromhex(match.group(1))
+        for offset in range(0, len(data) - 3, 4):
+            packed = int.from_bytes(data[offset:offset + 4], 'little')
+            time = packed & ((1 << TIME_BITS) - 1)
+            event = (packed >> TIME_BITS) & ((1 << EVENT_BITS) - 1)
+            arg = packed >> (TIME_BITS + EVENT_BITS)
+            if last_time is not None and time < last_time:
+                wraps += 1
+            last_time = time
+            yield (wraps << TIME_BITS) + time, event, arg
+
+
+def to_chrome(events):
+    trace = [{'ph': 'M', 'pid': PID, 'tid': APP_TID, 'name': 'thread_name',
+              'args': {'name': 'app'}}]
+    named = set()
+    timer = None
+    timer_id = 0
+    for time, event, arg in events:
+        name = EVENTS[event] if event < len(EVENTS) else 'event{}'.format(event)
+        entry = {'pid': PID, 'tid': APP_TID, 'ts': time * 1000, 'name': name}
+        if name in ('update_begin', 'update_end', 'mark_dirty'):
+            tid = LAYER_TID + arg
+            if tid not in named:
+                named.add(tid)
+                trace.append({'ph': 'M', 'pid': PID, 'tid': tid, 'name': 'thread_name',
+                              'args': {'name': layer_name(arg)}})
+            entry['tid'] = tid
+            if name == 'mark_dirty':
+                entry.update(ph='i', s='t')
+            else:
+                entry.update(ph='B' if name == 'update_begin' else 'E', name='update_proc')
+        elif name == 'timer_register':
+            timer_id += 1
+            delay = arg * DELAY_UNIT_MS
+            timer = (timer_id, time, delay)
+            entry.update(ph='b', cat='timer', id=timer_id, name='timer',
+                         args={'delay_ms': delay})
+        elif name in ('timer_fired', 'timer_cancel') and timer:
+            ident, start, delay = timer
+            timer = None
+            entry.update(ph='e', cat='timer', id=ident, name='timer')
+            if name == 'timer_fired':
+                entry['args'] = {'late_ms': time - start - delay}
+            else:
+                entry['args'] = {'cancelled': True}
+        else:
+            entry.update(ph='i', s='t')
+            if name == 'set_time':
+                entry['args'] = {'minute': arg}
+        trace.append(entry)
+    return {'traceEvents': trace, 'displayTimeUnit': 'ms'}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('log', nargs='?', help='captured log, standard input if omitted')
+    parser.add_argument('--out', help='output file, standard output if omitted')
+    args = parser.parse_args()
+
+    if args.log:
+        with open(args.log) as log:
+            trace = to_chrome(parse_log(log))
+    else:
+        trace = to_chrome(parse_log(sys.stdin))
+
+    if args.out:
+        with open(args.out, 'w') as out:
+            json.dump(trace, out)
+    else:
+        json.dump(trace, sys.stdout)
+    print('{} events'.format(len(trace['traceEvents'])), file=sys.stderr)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())